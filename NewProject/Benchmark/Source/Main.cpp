@@ -0,0 +1,600 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 18 Oct 2026 1:34:05pm
+    Author:  mikey
+
+    Headless offline renderer / benchmark for the Liszt processor.
+
+    Runs NewProjectAudioProcessor outside a host over a sweep of
+    configurations, times every processBlock call and prints per-block CPU
+    percentiles and the realtime factor. Optionally renders each run to WAV,
+    in a separate offline pass.
+
+    Usage:
+        LisztBenchmark [--midi file.mid] [--seconds 10] [--out folder]
+                       [--block-sizes 32,64,...] [--sample-rates 44100,...]
+                       [--csv results.csv] [--max-p99 50] [--quick]
+                       [--tail-seconds 5] [--tail-dither] [--freeze]
+                       [--oversampling 1|2|4] [--resampler linear|hermite|sinc]
+                       [--cull-db -90] [--no-cull]
+        LisztBenchmark --check-mixer
+
+    --max-p99 makes the run fail (exit code 1) when any configuration's p99
+    block time exceeds that percentage of the block deadline, so the
+    benchmark can be used as a regression gate. It also fails when more than
+    maxStarvedPercent of a configuration's blocks starved and weren't timed.
+
+    Blocks run the realtime path, as in a host. A block where the sample
+    streamer or the convolution's worker couldn't keep up (rendering far
+    faster than real time) isn't timed, the run pauses for it to catch up
+    and reports how many there were.
+
+    After the notes, every run renders --tail-seconds of silence and reports
+    that part separately: that's where the reverb tail decays towards
+    denormals. Only the blocks before the processor goes idle count, after
+    that it skips the reverb altogether. The idle column is how long into
+    the tail that took. --tail-dither switches the reverb's tail noise floor
+    on to compare against the default zero-flush.
+
+    --freeze lets the reverb play a rendered impulse response of the FDN
+    while nothing modulates it (configurations with the LFOs on stay live).
+
+    --oversampling runs the FDN's feedback saturation at 2x or 4x the sample
+    rate (1, the default, doesn't oversample).
+
+    --resampler sets the voices' interpolation (RESAMPLER_QUALITY, sinc by
+    default). Voices only interpolate while they bend, or at a host rate
+    whose resampled bank isn't in yet, so compare with --bend (semitones,
+    PITCH_BEND) to keep every voice on the kernel.
+
+    Voices that decay under --cull-db (dBFS) end early. The table shows the
+    most voices sounding at once and how many were culled, --no-cull keeps
+    every voice to the end of its envelope for comparison.
+
+    --check-mixer skips the benchmark and compares the FDN's closed-form
+    Hadamard and Householder mixers against the dense 16x16 matrices they
+    replaced, on random vectors. It fails when they differ by more than
+    float rounding.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include "../../Source/PluginProcessor.h"
+#include "../../Source/FDNMixer.h"
+
+//==============================================================================
+namespace
+{
+    struct Config
+    {
+        double sampleRate = 44100.0;
+        int blockSize = 512;
+        bool reverbEnabled = false;
+        bool lfosEnabled = false;
+
+        juce::String getName() const
+        {
+            return juce::String(sampleRate / 1000.0, 1) + "k_" + juce::String(blockSize)
+                + (reverbEnabled ? "_reverb" : "_dry")
+                + (lfosEnabled ? "_lfo" : "_nolfo");
+        }
+    };
+
+    struct Result
+    {
+        Config config;
+        double p50 = 0.0, p99 = 0.0, max = 0.0; // Seconds per block
+        double tailP50 = 0.0, tailP99 = 0.0; // Seconds per block while the tail decays
+        double idleSeconds = -1.0; // Into the tail, -1 if it never went idle
+        double realtimeFactor = 0.0;
+        double loadSeconds = 0.0; // Constructor only
+        double readySeconds = 0.0; // Until the samples are playable
+        int underrunFrames = 0;
+        int starvedBlocks = 0; // Not timed, a background thread fell behind
+        int numBlocks = 0; // Notes and tail
+        int peakVoices = 0;
+        int culledVoices = 0;
+    };
+
+    // Starved blocks aren't timed, so past a few of them the timings stop
+    // describing the run (all of them starving would pass on a p99 of 0)
+    constexpr double maxStarvedPercent = 1.0;
+
+    struct Options
+    {
+        juce::File midiFile, outputFolder, csvFile;
+        double seconds = 10.0;
+        double tailSeconds = 5.0;
+        bool tailDither = false;
+        bool freeze = false;
+        bool checkMixer = false;
+        int oversampling = 1;
+        int resamplerQuality = -1; // RESAMPLER_QUALITY index, -1 leaves the default
+        float bend = 0.0f;
+        float cullDecibels = Synth::defaultCullThreshold;
+        double maxP99Percent = 0.0;
+        juce::Array<int> blockSizes{ 32, 64, 128, 256, 512, 1024, 2048 };
+        juce::Array<double> sampleRates{ 44100.0, 48000.0, 88200.0, 96000.0, 192000.0 };
+    };
+
+    //==============================================================================
+    void setParameter(NewProjectAudioProcessor& processor, const juce::String& id, float value)
+    {
+        if (auto* parameter = processor.apvts.getParameter(id))
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+
+    // Repeating pattern of chords and runs over the keyboard range, times in seconds
+    juce::MidiMessageSequence createNotePattern(double lengthSeconds)
+    {
+        juce::MidiMessageSequence sequence;
+        juce::Random random(1234); // Same pattern every run
+
+        const int chordRoots[] = { 36, 43, 48, 55, 60, 65, 72, 79 };
+        double time = 0.0;
+        int step = 0;
+
+        while (time < lengthSeconds)
+        {
+            const int root = chordRoots[step % juce::numElementsInArray(chordRoots)];
+
+            // Chord
+            for (int interval : { 0, 4, 7, 12 })
+            {
+                const float velocity = 0.4f + 0.6f * random.nextFloat();
+                sequence.addEvent(juce::MidiMessage::noteOn(1, root + interval, velocity), time);
+                sequence.addEvent(juce::MidiMessage::noteOff(1, root + interval), time + 1.5);
+            }
+
+            // Fast run on top, keeps polyphony high
+            for (int i = 0; i < 8; ++i)
+            {
+                const double noteTime = time + 0.0625 * i;
+                const int note = juce::jlimit(24, 101, root + 12 + 2 * i);
+                sequence.addEvent(juce::MidiMessage::noteOn(1, note, 0.3f + 0.5f * random.nextFloat()), noteTime);
+                sequence.addEvent(juce::MidiMessage::noteOff(1, note), noteTime + 0.4);
+            }
+
+            time += 1.0;
+            ++step;
+        }
+
+        sequence.updateMatchedPairs();
+        sequence.sort();
+        return sequence;
+    }
+
+    juce::MidiMessageSequence loadMidiFile(const juce::File& file)
+    {
+        juce::MidiFile midiFile;
+        juce::FileInputStream stream(file);
+
+        if (!stream.openedOk() || !midiFile.readFrom(stream))
+        {
+            std::cerr << "Couldn't read MIDI file " << file.getFullPathName() << std::endl;
+            return {};
+        }
+
+        midiFile.convertTimestampTicksToSeconds();
+
+        juce::MidiMessageSequence sequence;
+        for (int track = 0; track < midiFile.getNumTracks(); ++track)
+            sequence.addSequence(*midiFile.getTrack(track), 0.0);
+
+        sequence.updateMatchedPairs();
+        sequence.sort();
+        return sequence;
+    }
+
+    double percentile(std::vector<double> values, double fraction)
+    {
+        if (values.empty())
+            return 0.0;
+
+        const auto index = static_cast<size_t>(fraction * (values.size() - 1) + 0.5);
+        std::nth_element(values.begin(), values.begin() + index, values.end());
+        return values[index];
+    }
+
+    //==============================================================================
+    // Parameters and options for the run, then prepareToPlay. Waits for the bank
+    // at the host rate, so voices don't convert on the fly while it's built
+    void prepare(NewProjectAudioProcessor& processor, const Config& config, const Options& options, bool nonRealtime)
+    {
+        setParameter(processor, "REVERB_ENABLED", config.reverbEnabled ? 1.0f : 0.0f);
+        setParameter(processor, "OSC1_ENABLED", config.lfosEnabled ? 1.0f : 0.0f);
+        setParameter(processor, "OSC2_ENABLED", config.lfosEnabled ? 1.0f : 0.0f);
+        setParameter(processor, "PITCH_BEND", options.bend);
+
+        if (options.resamplerQuality >= 0)
+            setParameter(processor, "RESAMPLER_QUALITY", static_cast<float>(options.resamplerQuality));
+        processor.setReverbTailDither(options.tailDither);
+        processor.setReverbFreezing(options.freeze);
+        processor.setReverbOversampling(options.oversampling);
+        processor.setVoiceCullThreshold(options.cullDecibels);
+        processor.setNonRealtime(nonRealtime);
+
+        processor.setRateAndBufferSizeDetails(config.sampleRate, config.blockSize);
+        processor.prepareToPlay(config.sampleRate, config.blockSize);
+
+        // Only the first run at a new rate waits
+        const auto bankGiveUpTime = juce::Time::getMillisecondCounter() + 120000;
+
+        while (!processor.areSamplesAtHostRate() && juce::Time::getMillisecondCounter() < bankGiveUpTime)
+            juce::Thread::sleep(1);
+    }
+
+    // Moves the events before blockEnd into the MIDI buffer, at sample offsets from blockStart
+    void addBlockEvents(juce::MidiBuffer& midi, const juce::MidiMessageSequence& notes, int& nextEvent,
+                        juce::int64 blockStart, juce::int64 blockEnd, double sampleRate)
+    {
+        midi.clear();
+
+        while (nextEvent < notes.getNumEvents())
+        {
+            const auto& message = notes.getEventPointer(nextEvent)->message;
+            const auto samplePosition = static_cast<juce::int64>(message.getTimeStamp() * sampleRate);
+
+            if (samplePosition >= blockEnd)
+                break;
+
+            midi.addEvent(message, static_cast<int>(juce::jmax<juce::int64>(0, samplePosition - blockStart)));
+            ++nextEvent;
+        }
+    }
+
+    // Same notes and settings as the timed run, rendered offline: voices wait
+    // for the streamer instead of dropping out, so the file is a clean render
+    void renderToFile(const Config& config, const juce::MidiMessageSequence& notes, const Options& options)
+    {
+        auto processor = std::make_unique<NewProjectAudioProcessor>();
+
+        while (!processor->areSamplesLoaded())
+            juce::Thread::sleep(1);
+
+        prepare(*processor, config, options, true);
+
+        const int numChannels = processor->getTotalNumOutputChannels();
+        auto file = options.outputFolder.getChildFile(config.getName() + ".wav");
+        file.deleteFile();
+
+        std::unique_ptr<juce::AudioFormatWriter> writer;
+
+        if (auto stream = file.createOutputStream())
+        {
+            juce::WavAudioFormat wav;
+            writer.reset(wav.createWriterFor(stream.get(), config.sampleRate,
+                static_cast<unsigned int>(numChannels), 24, {}, 0));
+
+            if (writer != nullptr)
+                stream.release(); // Owned by the writer now
+        }
+
+        if (writer == nullptr)
+        {
+            std::cerr << "Couldn't write " << file.getFullPathName() << std::endl;
+            return;
+        }
+
+        const auto totalSamples = static_cast<juce::int64>((options.seconds + options.tailSeconds) * config.sampleRate);
+        juce::AudioBuffer<float> buffer(numChannels, config.blockSize);
+        juce::MidiBuffer midi;
+        int nextEvent = 0;
+
+        for (juce::int64 blockStart = 0; blockStart < totalSamples; blockStart += config.blockSize)
+        {
+            addBlockEvents(midi, notes, nextEvent, blockStart, blockStart + config.blockSize, config.sampleRate);
+            buffer.clear();
+            processor->processBlock(buffer, midi);
+            writer->writeFromAudioSampleBuffer(buffer, 0, buffer.getNumSamples());
+        }
+
+        processor->releaseResources();
+    }
+
+    //==============================================================================
+    Result run(const Config& config, const juce::MidiMessageSequence& notes, const Options& options)
+    {
+        Result result;
+        result.config = config;
+
+        const auto loadStart = juce::Time::getHighResolutionTicks();
+        auto processor = std::make_unique<NewProjectAudioProcessor>();
+        result.loadSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - loadStart);
+
+        // Samples load in the background, rendering before they're in would just be silence
+        while (!processor->areSamplesLoaded())
+            juce::Thread::sleep(1);
+
+        result.readySeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - loadStart);
+
+        // Timed as a host would run it: nothing waits on the sample streamer or
+        // the convolution's worker, and the CPU budget is live
+        prepare(*processor, config, options, false);
+        const int numChannels = processor->getTotalNumOutputChannels();
+
+        const auto totalSamples = static_cast<juce::int64>(options.seconds * config.sampleRate);
+        const int numBlocks = static_cast<int>((totalSamples + config.blockSize - 1) / config.blockSize);
+        const int numTailBlocks = static_cast<int>(options.tailSeconds * config.sampleRate / config.blockSize);
+
+        juce::AudioBuffer<float> buffer(numChannels, config.blockSize);
+        juce::MidiBuffer midi;
+        std::vector<double> blockTimes, tailTimes;
+        blockTimes.reserve(static_cast<size_t>(numBlocks));
+        tailTimes.reserve(static_cast<size_t>(numTailBlocks));
+
+        int nextEvent = 0;
+        double totalProcessSeconds = 0.0;
+
+        result.numBlocks = numBlocks + numTailBlocks;
+
+        for (int block = 0; block < numBlocks + numTailBlocks; ++block)
+        {
+            const auto blockStart = static_cast<juce::int64>(block) * config.blockSize;
+            const auto blockEnd = blockStart + config.blockSize;
+
+            addBlockEvents(midi, notes, nextEvent, blockStart, blockEnd, config.sampleRate);
+            buffer.clear();
+
+            const int missedBefore = processor->getStreamUnderrunFrames() + processor->getNumMissedConvolutionBlocks();
+            const bool wasIdle = processor->isIdle();
+
+            const auto start = juce::Time::getHighResolutionTicks();
+            processor->processBlock(buffer, midi);
+            const auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+            // We render far faster than real time, so the background threads can
+            // fall behind where a host's pace wouldn't let them. A block that played
+            // silence for them isn't timed, and they get a block's time to catch up
+            if (processor->getStreamUnderrunFrames() + processor->getNumMissedConvolutionBlocks() != missedBefore)
+            {
+                ++result.starvedBlocks;
+                juce::Thread::sleep(juce::jmax(1, juce::roundToInt(1000.0 * config.blockSize / config.sampleRate)));
+            }
+            else if (block < numBlocks)
+            {
+                blockTimes.push_back(seconds);
+                totalProcessSeconds += seconds;
+            }
+            else if (!wasIdle)
+            {
+                tailTimes.push_back(seconds);
+            }
+            else if (result.idleSeconds < 0.0)
+            {
+                // Idle blocks skip the reverb, timing them would only flatter the tail
+                result.idleSeconds = static_cast<double>(block - numBlocks) * config.blockSize / config.sampleRate;
+            }
+
+            result.peakVoices = juce::jmax(result.peakVoices, processor->getNumActiveVoices());
+        }
+
+        processor->releaseResources();
+        result.underrunFrames = processor->getStreamUnderrunFrames();
+        result.culledVoices = processor->getNumVoicesCulled();
+
+        result.p50 = percentile(blockTimes, 0.50);
+        result.p99 = percentile(blockTimes, 0.99);
+        result.tailP50 = percentile(tailTimes, 0.50);
+        result.tailP99 = percentile(tailTimes, 0.99);
+        result.max = blockTimes.empty() ? 0.0 : *std::max_element(blockTimes.begin(), blockTimes.end());
+        result.realtimeFactor = totalProcessSeconds > 0.0
+            ? (static_cast<double>(blockTimes.size()) * config.blockSize / config.sampleRate) / totalProcessSeconds
+            : 0.0;
+
+        if (options.outputFolder != juce::File())
+            renderToFile(config, notes, options);
+
+        return result;
+    }
+
+    //==============================================================================
+    // Not bit-exact, the sums run in a different order, so each output may be
+    // off by float rounding
+    constexpr float mixerTolerance = 1.0e-6f;
+
+    bool checkMixer(int numVectors)
+    {
+        constexpr int numLines = FDNMixer::numLines;
+        float hadamardMatrix[numLines][numLines], householderMatrix[numLines][numLines];
+
+        for (int i = 0; i < numLines; ++i)
+        {
+            for (int j = 0; j < numLines; ++j)
+            {
+                // Sylvester's construction, negative where i and j share an odd number of bits
+                const bool negative = (juce::countNumberOfBits(static_cast<juce::uint32>(i & j)) & 1) != 0;
+                hadamardMatrix[i][j] = negative ? -0.25f : 0.25f;
+                householderMatrix[i][j] = (i == j ? 1.0f : 0.0f) - 2.0f / numLines;
+            }
+        }
+
+        // The matrix-vector product the reverb used to do, summed in the same order
+        auto multiply = [](const float (&matrix)[numLines][numLines], const float* input, float* output)
+        {
+            for (int i = 0; i < numLines; ++i)
+            {
+                output[i] = 0.0f;
+                for (int j = 0; j < numLines; ++j)
+                    output[i] += matrix[i][j] * input[j];
+            }
+        };
+
+        juce::Random random(1234);
+        float input[numLines], expected[numLines], mixed[numLines];
+        float hadamardError = 0.0f, householderError = 0.0f;
+
+        for (int vector = 0; vector < numVectors; ++vector)
+        {
+            for (auto& value : input)
+                value = 2.0f * random.nextFloat() - 1.0f;
+
+            multiply(hadamardMatrix, input, expected);
+            std::copy(std::begin(input), std::end(input), std::begin(mixed));
+            FDNMixer::hadamard(mixed);
+
+            for (int i = 0; i < numLines; ++i)
+                hadamardError = juce::jmax(hadamardError, std::abs(mixed[i] - expected[i]));
+
+            multiply(householderMatrix, input, expected);
+            std::copy(std::begin(input), std::end(input), std::begin(mixed));
+            FDNMixer::householder(mixed);
+
+            for (int i = 0; i < numLines; ++i)
+                householderError = juce::jmax(householderError, std::abs(mixed[i] - expected[i]));
+        }
+
+        std::cout << "FDN mixers against the dense matrices, " << numVectors << " random vectors" << std::endl
+                  << "  hadamard    max error " << hadamardError << std::endl
+                  << "  householder max error " << householderError << std::endl;
+
+        const bool passed = hadamardError <= mixerTolerance && householderError <= mixerTolerance;
+
+        if (!passed)
+            std::cout << "  FAIL: above " << mixerTolerance << std::endl;
+
+        return passed;
+    }
+
+    //==============================================================================
+    template <typename ValueType>
+    juce::Array<ValueType> parseList(const juce::String& text)
+    {
+        juce::Array<ValueType> values;
+        for (auto& token : juce::StringArray::fromTokens(text, ",", {}))
+            values.add(static_cast<ValueType>(token.getDoubleValue()));
+        return values;
+    }
+
+    Options parseOptions(const juce::StringArray& args)
+    {
+        Options options;
+
+        for (int i = 1; i < args.size(); ++i)
+        {
+            const auto& arg = args[i];
+            const auto next = (i + 1 < args.size()) ? args[i + 1] : juce::String();
+
+            if (arg == "--midi")               { options.midiFile = juce::File::getCurrentWorkingDirectory().getChildFile(next); ++i; }
+            else if (arg == "--out")           { options.outputFolder = juce::File::getCurrentWorkingDirectory().getChildFile(next); ++i; }
+            else if (arg == "--csv")           { options.csvFile = juce::File::getCurrentWorkingDirectory().getChildFile(next); ++i; }
+            else if (arg == "--seconds")       { options.seconds = next.getDoubleValue(); ++i; }
+            else if (arg == "--tail-seconds")  { options.tailSeconds = next.getDoubleValue(); ++i; }
+            else if (arg == "--tail-dither")   { options.tailDither = true; }
+            else if (arg == "--freeze")        { options.freeze = true; }
+            else if (arg == "--check-mixer")   { options.checkMixer = true; }
+            else if (arg == "--oversampling")  { options.oversampling = next.getIntValue(); ++i; }
+            else if (arg == "--resampler")     { options.resamplerQuality = juce::StringArray{ "linear", "hermite", "sinc" }.indexOf(next); ++i; }
+            else if (arg == "--bend")          { options.bend = next.getFloatValue(); ++i; }
+            else if (arg == "--cull-db")       { options.cullDecibels = next.getFloatValue(); ++i; }
+            else if (arg == "--no-cull")       { options.cullDecibels = Synth::cullOff; }
+            else if (arg == "--max-p99")       { options.maxP99Percent = next.getDoubleValue(); ++i; }
+            else if (arg == "--block-sizes")   { options.blockSizes = parseList<int>(next); ++i; }
+            else if (arg == "--sample-rates")  { options.sampleRates = parseList<double>(next); ++i; }
+            else if (arg == "--quick")
+            {
+                options.seconds = 4.0;
+                options.blockSizes = { 64, 512 };
+                options.sampleRates = { 48000.0 };
+            }
+        }
+
+        return options;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    const auto options = parseOptions(juce::StringArray(argv, argc));
+
+    if (options.checkMixer)
+        return checkMixer(100000) ? 0 : 1;
+
+    if (options.outputFolder != juce::File())
+        options.outputFolder.createDirectory();
+
+    const auto notes = options.midiFile.existsAsFile() ? loadMidiFile(options.midiFile)
+                                                       : createNotePattern(options.seconds);
+
+    juce::Array<Config> configs;
+    for (auto sampleRate : options.sampleRates)
+        for (auto blockSize : options.blockSizes)
+            for (bool reverb : { false, true })
+                for (bool lfos : { false, true })
+                    configs.add({ sampleRate, blockSize, reverb, lfos });
+
+    std::cout << juce::String("config").paddedRight(' ', 28)
+              << "  load ms ready ms   p50 %    p99 %    max %    RTF  tail p50 % tail p99 %  idle s  voices  culled" << std::endl;
+
+    juce::StringArray csv{ "config,sample_rate,block_size,reverb,lfos,load_ms,ready_ms,p50_us,p99_us,max_us,p99_percent,realtime_factor,tail_p50_us,tail_p99_us,idle_seconds,underrun_frames,starved_blocks,peak_voices,culled_voices" };
+    bool failed = false;
+
+    for (const auto& config : configs)
+    {
+        const auto result = run(config, notes, options);
+
+        // Block times as a percentage of the time the host gives us for one block
+        const double deadline = config.blockSize / config.sampleRate;
+        const double p50Percent = 100.0 * result.p50 / deadline;
+        const double p99Percent = 100.0 * result.p99 / deadline;
+        const double maxPercent = 100.0 * result.max / deadline;
+
+        std::cout << config.getName().paddedRight(' ', 28)
+                  << juce::String(result.loadSeconds * 1000.0, 1).paddedLeft(' ', 9)
+                  << juce::String(result.readySeconds * 1000.0, 1).paddedLeft(' ', 9)
+                  << juce::String(p50Percent, 2).paddedLeft(' ', 8)
+                  << juce::String(p99Percent, 2).paddedLeft(' ', 9)
+                  << juce::String(maxPercent, 2).paddedLeft(' ', 9)
+                  << juce::String(result.realtimeFactor, 1).paddedLeft(' ', 9)
+                  << juce::String(100.0 * result.tailP50 / deadline, 2).paddedLeft(' ', 11)
+                  << juce::String(100.0 * result.tailP99 / deadline, 2).paddedLeft(' ', 11)
+                  << (result.idleSeconds < 0.0 ? juce::String("-") : juce::String(result.idleSeconds, 2)).paddedLeft(' ', 8)
+                  << juce::String(result.peakVoices).paddedLeft(' ', 8)
+                  << juce::String(result.culledVoices).paddedLeft(' ', 8) << std::endl;
+
+        csv.add(config.getName() + "," + juce::String(config.sampleRate) + "," + juce::String(config.blockSize) + ","
+            + juce::String((int) config.reverbEnabled) + "," + juce::String((int) config.lfosEnabled) + ","
+            + juce::String(result.loadSeconds * 1000.0, 3) + "," + juce::String(result.readySeconds * 1000.0, 3) + ","
+            + juce::String(result.p50 * 1.0e6, 3) + "," + juce::String(result.p99 * 1.0e6, 3) + ","
+            + juce::String(result.max * 1.0e6, 3) + "," + juce::String(p99Percent, 3) + ","
+            + juce::String(result.realtimeFactor, 3) + ","
+            + juce::String(result.tailP50 * 1.0e6, 3) + "," + juce::String(result.tailP99 * 1.0e6, 3) + ","
+            + juce::String(result.idleSeconds, 3) + ","
+            + juce::String(result.underrunFrames) + "," + juce::String(result.starvedBlocks) + ","
+            + juce::String(result.peakVoices) + ","
+            + juce::String(result.culledVoices));
+
+        if (result.underrunFrames > 0)
+            std::cout << "  " << result.underrunFrames << " frames lost to sample streaming underruns" << std::endl;
+
+        const double starvedPercent = result.numBlocks > 0 ? 100.0 * result.starvedBlocks / result.numBlocks : 0.0;
+
+        if (result.starvedBlocks > 0)
+            std::cout << "  " << result.starvedBlocks << " blocks (" << juce::String(starvedPercent, 1)
+                      << "%) not timed, the streamer or convolution worker fell behind" << std::endl;
+
+        if (options.maxP99Percent > 0.0 && p99Percent > options.maxP99Percent)
+        {
+            std::cout << "  FAIL: p99 above " << options.maxP99Percent << "% of the block deadline" << std::endl;
+            failed = true;
+        }
+
+        if (options.maxP99Percent > 0.0 && starvedPercent > maxStarvedPercent)
+        {
+            std::cout << "  FAIL: more than " << maxStarvedPercent << "% of the blocks starved, the timings don't cover the run" << std::endl;
+            failed = true;
+        }
+    }
+
+    if (options.csvFile != juce::File())
+        options.csvFile.replaceWithText(csv.joinIntoString("\n") + "\n");
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    AllocationGuard.cpp
+    Created: 18 Oct 2026 10:12:31am
+    Author:  mikey
+
+  ==============================================================================
+*/
+
+#include "AllocationGuard.h"
+
+#if JUCE_DEBUG
+
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    // Both per thread, so other threads allocating never trips the audio thread's guard
+    thread_local int guardDepth = 0;
+    thread_local int guardedAllocations = 0;
+
+    void countAllocation() noexcept
+    {
+        if (guardDepth > 0)
+            ++guardedAllocations;
+    }
+
+    void* guardedMalloc(std::size_t size) noexcept
+    {
+        countAllocation();
+        return std::malloc(size == 0 ? 1 : size);
+    }
+
+   #if __cpp_aligned_new
+    void* guardedAlignedMalloc(std::size_t size, std::align_val_t alignment) noexcept
+    {
+        countAllocation();
+        const auto align = juce::jmax(static_cast<std::size_t>(alignment), sizeof(void*));
+
+       #if JUCE_WINDOWS
+        return _aligned_malloc(size == 0 ? 1 : size, align);
+       #else
+        void* ptr = nullptr;
+        return posix_memalign(&ptr, align, size == 0 ? 1 : size) == 0 ? ptr : nullptr;
+       #endif
+    }
+
+    void alignedFree(void* ptr) noexcept
+    {
+       #if JUCE_WINDOWS
+        _aligned_free(ptr);
+       #else
+        std::free(ptr);
+       #endif
+    }
+   #endif
+
+    template <typename Ptr>
+    Ptr* orThrow(Ptr* ptr)
+    {
+        if (ptr == nullptr)
+            throw std::bad_alloc();
+
+        return ptr;
+    }
+}
+
+// Global operators, so in a debug build these replace the allocator for the
+// whole process (the host included) wherever the plugin's binary gets to
+// interpose them. They only count, the memory comes from malloc as usual
+void* operator new(std::size_t size) { return orThrow(guardedMalloc(size)); }
+void* operator new[](std::size_t size) { return orThrow(guardedMalloc(size)); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return guardedMalloc(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return guardedMalloc(size); }
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+
+#if __cpp_aligned_new
+void* operator new(std::size_t size, std::align_val_t alignment) { return orThrow(guardedAlignedMalloc(size, alignment)); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return orThrow(guardedAlignedMalloc(size, alignment)); }
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return guardedAlignedMalloc(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return guardedAlignedMalloc(size, alignment); }
+void operator delete(void* ptr, std::align_val_t) noexcept { alignedFree(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { alignedFree(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { alignedFree(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { alignedFree(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { alignedFree(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { alignedFree(ptr); }
+#endif
+
+namespace AllocationGuard
+{
+    ScopedNoAllocation::ScopedNoAllocation() noexcept
+        : startCount(guardedAllocations)
+    {
+        ++guardDepth;
+    }
+
+    ScopedNoAllocation::~ScopedNoAllocation() noexcept
+    {
+        // Leave the guarded scope first, the assertion itself may log and allocate
+        --guardDepth;
+
+        // Something inside the audio callback hit the heap
+        jassert(guardedAllocations == startCount);
+    }
+
+    int getNumGuardedAllocations() noexcept
+    {
+        return guardedAllocations;
+    }
+}
+
+#else
+
+namespace AllocationGuard
+{
+    ScopedNoAllocation::ScopedNoAllocation() noexcept {}
+    ScopedNoAllocation::~ScopedNoAllocation() noexcept {}
+
+    int getNumGuardedAllocations() noexcept { return 0; }
+}
+
+#endif
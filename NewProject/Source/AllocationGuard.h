@@ -0,0 +1,38 @@
+/*
+  ==============================================================================
+
+    AllocationGuard.h
+    Created: 18 Oct 2026 10:12:31am
+    Author:  mikey
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+// Debug-only check that the audio thread never touches the heap.
+// In debug builds the global operator new (every overload) is replaced so that
+// every allocation made while a ScopedNoAllocation is alive on the current
+// thread is counted, and the guard asserts when it goes out of scope if
+// anything was allocated. The replacement is process-wide, but it only counts.
+// In release builds the guard compiles to nothing.
+namespace AllocationGuard
+{
+    class ScopedNoAllocation
+    {
+    public:
+        ScopedNoAllocation() noexcept;
+        ~ScopedNoAllocation() noexcept;
+
+    private:
+       #if JUCE_DEBUG
+        int startCount = 0;
+       #endif
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedNoAllocation)
+    };
+
+    // Allocations this thread has made inside a guarded scope (always 0 in release)
+    int getNumGuardedAllocations() noexcept;
+}
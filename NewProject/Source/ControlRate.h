@@ -0,0 +1,48 @@
+/*
+  ==============================================================================
+
+    ControlRate.h
+    Created: 23 Oct 2026 10:14:52am
+    Author:  mikey
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+// Modulation runs at a control rate: one point every 'interval' samples, and the
+// DSP ramps linearly between them. A block of numSamples has a point at sample
+// 0, interval, 2 * interval... and one more at or past the end to ramp towards,
+// so point k always sits at sample k * interval.
+namespace ControlRate
+{
+    // Samples between points. Plenty for LFOs in the few Hz range
+    static constexpr int defaultInterval = 16;
+    static constexpr int minInterval = 1;
+    static constexpr int maxInterval = 256;
+
+    inline int getNumPoints(int numSamples, int interval) noexcept
+    {
+        return (juce::jmax(0, numSamples) + interval - 1) / interval + 1;
+    }
+
+    // Linear ramp between two neighbouring points, one next() per sample
+    struct Ramp
+    {
+        float value = 0.0f, step = 0.0f;
+
+        void start(float from, float to, int numSteps) noexcept
+        {
+            value = from;
+            step = (to - from) / static_cast<float>(numSteps);
+        }
+
+        float next() noexcept
+        {
+            const float current = value;
+            value += step;
+            return current;
+        }
+    };
+}
@@ -0,0 +1,637 @@
+/*
+  ==============================================================================
+
+    ConvolutionReverb.cpp
+    Created: 25 Oct 2026 11:02:18am
+    Author:  mikey
+
+  ==============================================================================
+*/
+
+#include "ConvolutionReverb.h"
+#include "Resampler.h"
+
+namespace
+{
+    // Body partitions are headSize long (FFT of 2 * headSize), tail partitions tailBlockSize
+    constexpr int bodyOrder = 7;
+    constexpr int tailOrder = 11;
+    static_assert((1 << bodyOrder) == 2 * ConvolutionReverb::headSize, "body FFT must be two head blocks");
+    static_assert((1 << tailOrder) == 2 * ConvolutionReverb::tailBlockSize, "tail FFT must be two tail blocks");
+
+    // The offline renders' patience with the worker, like the sample streamer's
+    constexpr juce::uint32 workerTimeoutMs = 2000;
+
+    template <typename Condition>
+    bool waitFor(Condition isReady) noexcept
+    {
+        const auto giveUpTime = juce::Time::getMillisecondCounter() + workerTimeoutMs;
+
+        while (!isReady() && juce::Time::getMillisecondCounter() < giveUpTime)
+            juce::Thread::yield();
+
+        return isReady();
+    }
+
+    // acc += a * b over numBins of JUCE's interleaved (re, im) spectra
+    void multiplyAdd(float* acc, const float* a, const float* b, int numBins) noexcept
+    {
+        for (int i = 0; i < numBins; ++i)
+        {
+            const float re = a[2 * i] * b[2 * i] - a[2 * i + 1] * b[2 * i + 1];
+            const float im = a[2 * i] * b[2 * i + 1] + a[2 * i + 1] * b[2 * i];
+            acc[2 * i] += re;
+            acc[2 * i + 1] += im;
+        }
+    }
+
+    // Drops the silence at the end, anything 100dB under the peak
+    int getAudibleLength(const juce::AudioBuffer<float>& buffer, int numSamples)
+    {
+        float peak = 0.0f;
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            peak = juce::jmax(peak, buffer.getMagnitude(ch, 0, numSamples));
+
+        const float threshold = peak * 1.0e-5f;
+        int length = 0;
+
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            const float* data = buffer.getReadPointer(ch);
+
+            for (int i = numSamples; i > length; --i)
+            {
+                if (std::abs(data[i - 1]) > threshold)
+                {
+                    length = i;
+                    break;
+                }
+            }
+        }
+
+        return length;
+    }
+}
+
+//==============================================================================
+// One IR at one sample rate. Built off the audio thread, played on the audio
+// thread, with its own worker for the tail partitions. Never resized once built
+class ConvolutionReverb::Engine : private juce::Thread
+{
+public:
+    Engine(const juce::AudioBuffer<float>& impulseResponse, int numChannels, juce::uint32 version);
+    ~Engine() override;
+
+    const juce::uint32 version;
+
+    void reset() noexcept;
+    void process(juce::AudioBuffer<float>& buffer, const float* dryWetPoints, int interval,
+                 bool monoInput, bool waitForWorker, std::atomic<int>& numMissedBlocks) noexcept;
+
+private:
+    void run() override;
+
+    // Uniformly partitioned overlap-save. Spectra are blockSize + 1 bins
+    struct Partitions
+    {
+        int numPartitions = 0;
+        int spectrumSize = 0;           // Floats per spectrum
+        std::vector<float> filters;     // The IR's partitions, first to last
+        std::vector<float> inputs;      // The last numPartitions input frames, a ring
+        int newest = 0;
+
+        void prepare(const float* impulse, int impulseLength, int offset, int blockSize, int count,
+                     juce::dsp::FFT& fft, std::vector<float>& scratch);
+        void clear() noexcept;
+
+        // 'frame' holds the last two blocks of input (and room for the FFT),
+        // the block's output ends up in accumulator[blockSize, 2 * blockSize)
+        void convolve(juce::dsp::FFT& fft, float* frame, float* accumulator, int blockSize) noexcept;
+    };
+
+    struct Channel
+    {
+        // Head: the IR's first headSize samples reversed, and the last headSize
+        // inputs twice over so they're always contiguous
+        std::vector<float> headTaps, headHistory;
+        int headWrite = 0;
+
+        // Body: the last two head blocks of input, and the output for the next one
+        Partitions body;
+        std::vector<float> bodyFrame, bodyOutput;
+
+        // Tail: this block's input (audio thread), and the one before (worker)
+        Partitions tail;
+        std::vector<float> tailInput, tailPrevious;
+    };
+
+    // The tail's hand-over. Block n's input goes into slots[n % numSlots] at the
+    // end of block n, its output plays during block n + 2
+    struct Slot
+    {
+        std::vector<float> input, output;  // tailBlockSize per channel
+        bool clearFirst = false;
+        std::atomic<int> inputBlock{ -1 }, outputBlock{ -1 };
+    };
+
+    static constexpr int numSlots = 3;
+
+    void finishTailBlock(bool waitForWorker, std::atomic<int>& numMissedBlocks) noexcept;
+    void convolveTail(Slot& slot) noexcept;
+
+    std::vector<Channel> channels;
+    juce::dsp::FFT bodyFft{ bodyOrder }, tailFft{ tailOrder };
+
+    // Audio thread
+    std::vector<float> bodyScratch, bodyAccumulator;
+    int position = 0;                   // Within the tail block, so within the head block too
+    int block = 0;                      // The tail block being filled
+    int firstValidBlock = 0;            // Blocks before this were filled before a reset()
+    bool clearNextBlock = false;
+    const float* tailOutput = nullptr;  // Output for the current block, nullptr for silence
+
+    // Worker
+    std::array<Slot, numSlots> slots;
+    std::atomic<int> lastSubmittedBlock{ -1 };
+    int workerBlock = 0;
+    std::vector<float> tailScratch, tailAccumulator;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Engine)
+};
+
+void ConvolutionReverb::Engine::Partitions::prepare(const float* impulse, int impulseLength, int offset, int blockSize,
+                                                    int count, juce::dsp::FFT& fft, std::vector<float>& scratch)
+{
+    numPartitions = count;
+    spectrumSize = 2 * blockSize + 2;
+    filters.assign(static_cast<size_t>(numPartitions * spectrumSize), 0.0f);
+    inputs.assign(filters.size(), 0.0f);
+    newest = 0;
+
+    for (int p = 0; p < numPartitions; ++p)
+    {
+        std::fill(scratch.begin(), scratch.end(), 0.0f);
+
+        const int start = offset + p * blockSize;
+        const int length = juce::jlimit(0, blockSize, impulseLength - start);
+        std::copy_n(impulse + start, length, scratch.data());
+
+        fft.performRealOnlyForwardTransform(scratch.data(), true);
+        std::copy_n(scratch.data(), spectrumSize, filters.data() + p * spectrumSize);
+    }
+}
+
+void ConvolutionReverb::Engine::Partitions::clear() noexcept
+{
+    std::fill(inputs.begin(), inputs.end(), 0.0f);
+    newest = 0;
+}
+
+void ConvolutionReverb::Engine::Partitions::convolve(juce::dsp::FFT& fft, float* frame, float* accumulator, int blockSize) noexcept
+{
+    fft.performRealOnlyForwardTransform(frame, true);
+
+    newest = (newest + 1) % numPartitions;
+    std::copy_n(frame, spectrumSize, inputs.data() + newest * spectrumSize);
+
+    // Partition p meets the input from p blocks ago
+    std::fill_n(accumulator, 4 * blockSize, 0.0f);
+    for (int p = 0, input = newest; p < numPartitions; ++p)
+    {
+        multiplyAdd(accumulator, inputs.data() + input * spectrumSize, filters.data() + p * spectrumSize, blockSize + 1);
+        input = (input == 0 ? numPartitions : input) - 1;
+    }
+
+    fft.performRealOnlyInverseTransform(accumulator);
+}
+
+ConvolutionReverb::Engine::Engine(const juce::AudioBuffer<float>& impulseResponse, int numChannels, juce::uint32 engineVersion)
+    : juce::Thread("Liszt convolution tail"), version(engineVersion)
+{
+    const int length = impulseResponse.getNumSamples();
+    const int bodyEnd = 2 * tailBlockSize;
+
+    // The body covers [headSize, 2 * tailBlockSize), the tail everything after
+    const int numBodyPartitions = juce::jlimit(0, bodyEnd / headSize - 1, (juce::jmin(length, bodyEnd) - 1) / headSize);
+    const int numTailPartitions = juce::jmax(0, (length - bodyEnd + tailBlockSize - 1) / tailBlockSize);
+
+    bodyScratch.assign(4 * headSize, 0.0f);
+    bodyAccumulator.assign(4 * headSize, 0.0f);
+    tailScratch.assign(4 * tailBlockSize, 0.0f);
+    tailAccumulator.assign(4 * tailBlockSize, 0.0f);
+
+    channels.resize(static_cast<size_t>(juce::jmax(1, numChannels)));
+
+    for (size_t ch = 0; ch < channels.size(); ++ch)
+    {
+        auto& channel = channels[ch];
+        const float* impulse = impulseResponse.getReadPointer(juce::jmin(static_cast<int>(ch), impulseResponse.getNumChannels() - 1));
+
+        channel.headTaps.assign(headSize, 0.0f);
+        for (int i = 0; i < juce::jmin(headSize, length); ++i)
+            channel.headTaps[static_cast<size_t>(headSize - 1 - i)] = impulse[i];
+        channel.headHistory.assign(2 * headSize, 0.0f);
+
+        channel.body.prepare(impulse, length, headSize, headSize, numBodyPartitions, bodyFft, bodyScratch);
+        channel.bodyFrame.assign(2 * headSize, 0.0f);
+        channel.bodyOutput.assign(headSize, 0.0f);
+
+        channel.tail.prepare(impulse, length, bodyEnd, tailBlockSize, numTailPartitions, tailFft, tailScratch);
+        channel.tailInput.assign(tailBlockSize, 0.0f);
+        channel.tailPrevious.assign(tailBlockSize, 0.0f);
+    }
+
+    for (auto& slot : slots)
+    {
+        slot.input.assign(channels.size() * tailBlockSize, 0.0f);
+        slot.output.assign(channels.size() * tailBlockSize, 0.0f);
+    }
+
+    // Short IRs don't reach the tail
+    if (numTailPartitions > 0)
+        startThread(juce::Thread::Priority::high);
+}
+
+ConvolutionReverb::Engine::~Engine()
+{
+    stopThread(2000);
+}
+
+void ConvolutionReverb::Engine::reset() noexcept
+{
+    for (auto& channel : channels)
+    {
+        std::fill(channel.headHistory.begin(), channel.headHistory.end(), 0.0f);
+        channel.headWrite = 0;
+        channel.body.clear();
+        std::fill(channel.bodyFrame.begin(), channel.bodyFrame.end(), 0.0f);
+        std::fill(channel.bodyOutput.begin(), channel.bodyOutput.end(), 0.0f);
+        std::fill(channel.tailInput.begin(), channel.tailInput.end(), 0.0f);
+    }
+
+    // The worker clears its side when it gets the next block, and anything
+    // already on its way is ignored
+    position = 0;
+    firstValidBlock = block;
+    clearNextBlock = true;
+    tailOutput = nullptr;
+}
+
+void ConvolutionReverb::Engine::process(juce::AudioBuffer<float>& buffer, const float* dryWetPoints, int interval,
+                                        bool monoInput, bool waitForWorker, std::atomic<int>& numMissedBlocks) noexcept
+{
+    const int numSamples = buffer.getNumSamples();
+    const int numChannels = juce::jmin(buffer.getNumChannels(), static_cast<int>(channels.size()));
+    interval = juce::jmax(1, interval);
+
+    for (int start = 0; start < numSamples;)
+    {
+        // Up to the next head block, where the body's FFT runs
+        const int offset = position % headSize;
+        const int count = juce::jmin(numSamples - start, headSize - offset);
+
+        // Every channel's IR gets the average of the input channels, as in the FDN
+        std::array<float, headSize> mono;
+        if (monoInput)
+        {
+            juce::FloatVectorOperations::copy(mono.data(), buffer.getReadPointer(0, start), count);
+            for (int ch = 1; ch < buffer.getNumChannels(); ++ch)
+                juce::FloatVectorOperations::add(mono.data(), buffer.getReadPointer(ch, start), count);
+            juce::FloatVectorOperations::multiply(mono.data(), 1.0f / static_cast<float>(buffer.getNumChannels()), count);
+        }
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto& channel = channels[static_cast<size_t>(ch)];
+            float* data = buffer.getWritePointer(ch, start);
+            const float* tail = tailOutput != nullptr ? tailOutput + ch * tailBlockSize + position : nullptr;
+
+            // Dry/wet ramps between the control points, picked up mid-interval
+            ControlRate::Ramp dryWetRamp;
+            dryWetRamp.start(1.0f, 1.0f, 1);
+
+            for (int i = 0; i < count; ++i)
+            {
+                const int sample = start + i;
+
+                if (dryWetPoints != nullptr && (i == 0 || (sample % interval) == 0))
+                {
+                    const int point = sample / interval;
+                    const int into = sample - point * interval;
+                    const float from = juce::jlimit(0.0f, 1.0f, dryWetPoints[point]);
+                    const float to = juce::jlimit(0.0f, 1.0f, dryWetPoints[point + 1]);
+                    dryWetRamp.start(from + (to - from) * static_cast<float>(into) / static_cast<float>(interval), to, interval - into);
+                }
+
+                const float dry = data[i];
+                const float input = monoInput ? mono[static_cast<size_t>(i)] : dry;
+                const float dryWet = dryWetRamp.next();
+
+                channel.headHistory[static_cast<size_t>(channel.headWrite)] = input;
+                channel.headHistory[static_cast<size_t>(channel.headWrite + headSize)] = input;
+                if (++channel.headWrite == headSize)
+                    channel.headWrite = 0;
+
+                // Oldest first, against the reversed taps
+                const float* history = channel.headHistory.data() + channel.headWrite;
+                float wet = channel.bodyOutput[static_cast<size_t>(offset + i)];
+                for (int tap = 0; tap < headSize; ++tap)
+                    wet += channel.headTaps[static_cast<size_t>(tap)] * history[tap];
+
+                if (tail != nullptr)
+                    wet += tail[i];
+
+                channel.bodyFrame[static_cast<size_t>(headSize + offset + i)] = input;
+                channel.tailInput[static_cast<size_t>(position + i)] = input;
+
+                data[i] = dryWet < 1.0f ? dry * (1.0f - dryWet) + wet * dryWet : wet;
+            }
+        }
+
+        start += count;
+        position += count;
+
+        if ((position % headSize) != 0)
+            continue;
+
+        // The body's output for the next head block
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto& channel = channels[static_cast<size_t>(ch)];
+
+            if (channel.body.numPartitions > 0)
+            {
+                std::copy(channel.bodyFrame.begin(), channel.bodyFrame.end(), bodyScratch.begin());
+                channel.body.convolve(bodyFft, bodyScratch.data(), bodyAccumulator.data(), headSize);
+                std::copy_n(bodyAccumulator.data() + headSize, headSize, channel.bodyOutput.data());
+            }
+
+            std::copy_n(channel.bodyFrame.data() + headSize, headSize, channel.bodyFrame.data());
+        }
+
+        if (position == tailBlockSize)
+        {
+            if (channels[0].tail.numPartitions > 0)
+                finishTailBlock(waitForWorker, numMissedBlocks);
+
+            position = 0;
+        }
+    }
+}
+
+void ConvolutionReverb::Engine::finishTailBlock(bool waitForWorker, std::atomic<int>& numMissedBlocks) noexcept
+{
+    // Hand this block to the worker, if it's done with the one that used the slot before
+    auto& slot = slots[static_cast<size_t>(block % numSlots)];
+    const int previous = slot.inputBlock.load(std::memory_order_relaxed);
+    auto isFree = [&slot, previous] { return previous < 0 || slot.outputBlock.load(std::memory_order_acquire) == previous; };
+
+    if (isFree() || (waitForWorker && waitFor(isFree)))
+    {
+        for (size_t ch = 0; ch < channels.size(); ++ch)
+            std::copy(channels[ch].tailInput.begin(), channels[ch].tailInput.end(), slot.input.begin() + static_cast<std::ptrdiff_t>(ch * tailBlockSize));
+
+        slot.clearFirst = clearNextBlock;
+        clearNextBlock = false;
+        slot.inputBlock.store(block, std::memory_order_release);
+    }
+    else
+    {
+        // The worker treats it as silence
+        numMissedBlocks.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    lastSubmittedBlock.store(block, std::memory_order_release);
+    notify();
+
+    // The block starting now plays the output of the one before this
+    const int ready = block - 1;
+    auto& readySlot = slots[static_cast<size_t>((ready + numSlots) % numSlots)];
+    auto isDone = [&readySlot, ready] { return readySlot.outputBlock.load(std::memory_order_acquire) == ready; };
+    tailOutput = nullptr;
+
+    // A block that was never handed over has already been counted
+    if (ready >= firstValidBlock && readySlot.inputBlock.load(std::memory_order_relaxed) == ready)
+    {
+        if (isDone() || (waitForWorker && waitFor(isDone)))
+            tailOutput = readySlot.output.data();
+        else
+            numMissedBlocks.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    ++block;
+}
+
+void ConvolutionReverb::Engine::run()
+{
+    // Same as the audio thread, a decaying tail would otherwise end in denormals
+    juce::ScopedNoDenormals noDenormals;
+
+    while (!threadShouldExit())
+    {
+        if (workerBlock > lastSubmittedBlock.load(std::memory_order_acquire))
+        {
+            wait(-1);
+            continue;
+        }
+
+        auto& slot = slots[static_cast<size_t>(workerBlock % numSlots)];
+
+        if (slot.inputBlock.load(std::memory_order_acquire) == workerBlock)
+        {
+            convolveTail(slot);
+            slot.outputBlock.store(workerBlock, std::memory_order_release);
+        }
+        else
+        {
+            // Missed: silence in, so the partitions stay in step with time
+            for (auto& channel : channels)
+            {
+                std::fill(tailScratch.begin(), tailScratch.end(), 0.0f);
+                channel.tail.convolve(tailFft, tailScratch.data(), tailAccumulator.data(), tailBlockSize);
+                std::fill(channel.tailPrevious.begin(), channel.tailPrevious.end(), 0.0f);
+            }
+        }
+
+        ++workerBlock;
+    }
+}
+
+void ConvolutionReverb::Engine::convolveTail(Slot& slot) noexcept
+{
+    for (size_t ch = 0; ch < channels.size(); ++ch)
+    {
+        auto& channel = channels[ch];
+        const float* input = slot.input.data() + ch * tailBlockSize;
+
+        if (slot.clearFirst)
+        {
+            channel.tail.clear();
+            std::fill(channel.tailPrevious.begin(), channel.tailPrevious.end(), 0.0f);
+        }
+
+        std::copy(channel.tailPrevious.begin(), channel.tailPrevious.end(), tailScratch.begin());
+        std::copy_n(input, tailBlockSize, tailScratch.data() + tailBlockSize);
+        std::copy_n(input, tailBlockSize, channel.tailPrevious.data());
+
+        channel.tail.convolve(tailFft, tailScratch.data(), tailAccumulator.data(), tailBlockSize);
+        std::copy_n(tailAccumulator.data() + tailBlockSize, tailBlockSize, slot.output.data() + ch * tailBlockSize);
+    }
+}
+
+//==============================================================================
+ConvolutionReverb::ConvolutionReverb()
+{
+}
+
+ConvolutionReverb::~ConvolutionReverb()
+{
+    delete pendingEngine.exchange(nullptr);
+    delete retiredEngine.exchange(nullptr);
+}
+
+bool ConvolutionReverb::loadImpulseResponse(const juce::File& file)
+{
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(file));
+
+    if (reader == nullptr || reader->sampleRate <= 0.0 || reader->lengthInSamples <= 0)
+        return false;
+
+    const int numImpulseChannels = juce::jlimit(1, 2, static_cast<int>(reader->numChannels));
+    const auto length = static_cast<int>(juce::jmin(reader->lengthInSamples,
+        static_cast<juce::int64>(maxImpulseSeconds * reader->sampleRate)));
+
+    juce::AudioBuffer<float> impulseResponse(numImpulseChannels, length);
+
+    if (!reader->read(&impulseResponse, 0, length, 0, true, numImpulseChannels > 1))
+        return false;
+
+    setImpulseResponse(impulseResponse, reader->sampleRate);
+    return true;
+}
+
+juce::uint32 ConvolutionReverb::setImpulseResponse(const juce::AudioBuffer<float>& impulseResponse, double impulseSampleRate, bool normalise)
+{
+    jassert(impulseSampleRate > 0.0);
+
+    const int numImpulseChannels = juce::jmin(2, impulseResponse.getNumChannels());
+    const int length = getAudibleLength(impulseResponse,
+        juce::jmin(impulseResponse.getNumSamples(), static_cast<int>(maxImpulseSeconds * impulseSampleRate)));
+
+    if (numImpulseChannels <= 0 || length <= 0 || impulseSampleRate <= 0.0)
+        return 0;
+
+    impulse.setSize(numImpulseChannels, length);
+    for (int ch = 0; ch < numImpulseChannels; ++ch)
+        impulse.copyFrom(ch, 0, impulseResponse, ch, 0, length);
+
+    impulseRate = impulseSampleRate;
+    normaliseImpulse = normalise;
+    impulseSeconds.store(length / impulseSampleRate, std::memory_order_relaxed);
+    publish(createEngine());
+    return lastVersion;
+}
+
+void ConvolutionReverb::prepare(double newSampleRate, int newNumChannels)
+{
+    sampleRate = newSampleRate;
+    numChannels = juce::jmax(1, newNumChannels);
+
+    // The audio thread is stopped, so its engine can be swapped directly
+    freeRetiredEngine();
+    delete pendingEngine.exchange(nullptr);
+    engine = createEngine();
+}
+
+bool ConvolutionReverb::hasImpulseResponse() const noexcept
+{
+    return hasEngine.load(std::memory_order_acquire);
+}
+
+void ConvolutionReverb::reset() noexcept
+{
+    if (engine != nullptr)
+        engine->reset();
+}
+
+juce::uint32 ConvolutionReverb::updateImpulseResponse() noexcept
+{
+    // A new IR only comes in once the loading thread has freed the last one let go of
+    if (pendingEngine.load(std::memory_order_acquire) != nullptr && retiredEngine.load(std::memory_order_acquire) == nullptr)
+    {
+        retiredEngine.store(engine.release(), std::memory_order_release);
+        engine.reset(pendingEngine.exchange(nullptr, std::memory_order_acq_rel));
+    }
+
+    return engine != nullptr ? engine->version : 0;
+}
+
+void ConvolutionReverb::process(juce::AudioBuffer<float>& buffer, const float* dryWetPoints, int interval) noexcept
+{
+    updateImpulseResponse();
+
+    if (engine != nullptr)
+        engine->process(buffer, dryWetPoints, interval, monoInput.load(std::memory_order_relaxed),
+                        nonRealtime.load(std::memory_order_relaxed), numMissedBlocks);
+}
+
+std::unique_ptr<ConvolutionReverb::Engine> ConvolutionReverb::createEngine()
+{
+    if (impulse.getNumSamples() == 0)
+        return nullptr;
+
+    juce::AudioBuffer<float> atHostRate;
+
+    if (std::abs(impulseRate - sampleRate) > 1.0e-6 * sampleRate)
+    {
+        const Resampler::Offline resampler(impulseRate / sampleRate);
+        const auto length = static_cast<int>(resampler.getOutputLength(impulse.getNumSamples()));
+
+        atHostRate.setSize(impulse.getNumChannels(), length);
+        for (int ch = 0; ch < impulse.getNumChannels(); ++ch)
+            resampler.process(impulse.getReadPointer(ch), impulse.getNumSamples(), atHostRate.getWritePointer(ch), length);
+    }
+    else
+    {
+        atHostRate.makeCopyOf(impulse);
+    }
+
+    // Unit energy per channel at the rate it plays at (resampling changes it)
+    if (normaliseImpulse)
+    {
+        double energy = 0.0;
+        for (int ch = 0; ch < atHostRate.getNumChannels(); ++ch)
+        {
+            const float* data = atHostRate.getReadPointer(ch);
+            for (int i = 0; i < atHostRate.getNumSamples(); ++i)
+                energy += static_cast<double>(data[i]) * data[i];
+        }
+
+        energy /= atHostRate.getNumChannels();
+        if (energy > 0.0)
+            atHostRate.applyGain(static_cast<float>(1.0 / std::sqrt(energy)));
+    }
+
+    return std::make_unique<Engine>(atHostRate, numChannels, ++lastVersion);
+}
+
+void ConvolutionReverb::publish(std::unique_ptr<Engine> newEngine)
+{
+    freeRetiredEngine();
+
+    if (newEngine == nullptr)
+        return;
+
+    hasEngine.store(true, std::memory_order_release);
+
+    // One the audio thread never picked up can go straight away
+    delete pendingEngine.exchange(newEngine.release(), std::memory_order_acq_rel);
+}
+
+void ConvolutionReverb::freeRetiredEngine()
+{
+    delete retiredEngine.exchange(nullptr, std::memory_order_acq_rel);
+}
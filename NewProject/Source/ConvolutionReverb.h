@@ -0,0 +1,106 @@
+/*
+  ==============================================================================
+
+    ConvolutionReverb.h
+    Created: 25 Oct 2026 11:02:18am
+    Author:  mikey
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "ControlRate.h"
+
+// Impulse response reverb, the alternative to FDNReverb for measured rooms.
+// The IR is split in three so there's no latency and the audio thread's cost
+// doesn't grow with the IR's length:
+//  - the first headSize samples as a direct-form FIR
+//  - up to 2 * tailBlockSize in headSize partitions (uniformly partitioned
+//    overlap-save, on the audio thread)
+//  - the rest in tailBlockSize partitions on a worker thread, which has a
+//    whole tailBlockSize of audio to finish each block in
+// IRs are capped at maxImpulseSeconds, which bounds the worker's cost too.
+class ConvolutionReverb
+{
+public:
+    ConvolutionReverb();
+    ~ConvolutionReverb();
+
+    static constexpr int headSize = 64;
+    static constexpr int tailBlockSize = 1024;
+    static constexpr double maxImpulseSeconds = 10.0;
+
+    // Loading and prepare() happen on one thread at a time, never the audio thread.
+    // A mono or stereo file in any format the basic formats read, false if it can't be opened
+    bool loadImpulseResponse(const juce::File& file);
+
+    // Any rate, it's resampled to the host's. Normalised to unit energy by
+    // default, so rooms of different sizes come out at a similar level. The
+    // audio thread picks it up at the start of its next block. Returns the
+    // version it'll have there (see updateImpulseResponse()), 0 if it's empty
+    juce::uint32 setImpulseResponse(const juce::AudioBuffer<float>& impulseResponse, double impulseSampleRate, bool normalise = true);
+
+    // From prepareToPlay. Rebuilds the current IR for the rate (as a new version)
+    void prepare(double newSampleRate, int newNumChannels);
+
+    // Audio thread: takes in a new impulse response if one is waiting (process()
+    // does too), and returns the version playing now, 0 for none
+    juce::uint32 updateImpulseResponse() noexcept;
+
+    // Once an impulse response is in, or on its way to the audio thread
+    bool hasImpulseResponse() const noexcept;
+
+    // The latest impulse response's length once trimmed, 0 before there's one. Any thread
+    double getImpulseResponseSeconds() const noexcept { return impulseSeconds.load(std::memory_order_relaxed); }
+
+    // Audio thread: drops the tail, e.g. before switching over to convolution
+    void reset() noexcept;
+
+    // Audio thread: adds the reverb to 'buffer' in place, with dry/wet at
+    // control rate like FDNReverb (no points is fully wet). Channels past the
+    // IR's use its last one
+    void process(juce::AudioBuffer<float>& buffer, const float* dryWetPoints, int interval) noexcept;
+
+    // Tail blocks the worker didn't finish in time (played as silence)
+    int getNumMissedBlocks() const noexcept { return numMissedBlocks.load(std::memory_order_relaxed); }
+
+    // Offline rendering: wait for the worker instead of missing blocks
+    void setNonRealtime(bool shouldWait) noexcept { nonRealtime.store(shouldWait, std::memory_order_relaxed); }
+
+    // Convolve every channel's IR with the average of the input channels instead
+    // of its own, the way FDNReverb takes its input. The dry signal stays as it is
+    void setMonoInput(bool shouldSum) noexcept { monoInput.store(shouldSum, std::memory_order_relaxed); }
+
+private:
+    class Engine;
+
+    // Hands a new engine to the audio thread, and frees the one it let go of
+    void publish(std::unique_ptr<Engine> newEngine);
+    void freeRetiredEngine();
+    std::unique_ptr<Engine> createEngine();
+
+    // The audio thread's engine. Only prepare() and the destructor touch it
+    // from elsewhere, when the audio thread isn't running
+    std::unique_ptr<Engine> engine;
+
+    // Waiting for the audio thread, and let go of by it, both freed by the loading thread
+    std::atomic<Engine*> pendingEngine{ nullptr };
+    std::atomic<Engine*> retiredEngine{ nullptr };
+
+    // The IR as it was given, kept to rebuild at a new rate
+    juce::AudioBuffer<float> impulse;
+    double impulseRate = 0.0;
+    bool normaliseImpulse = true;
+    juce::uint32 lastVersion = 0;
+    std::atomic<bool> hasEngine{ false };
+    std::atomic<double> impulseSeconds{ 0.0 };
+
+    double sampleRate = 44100.0;
+    int numChannels = 2;
+
+    std::atomic<bool> nonRealtime{ false }, monoInput{ false };
+    std::atomic<int> numMissedBlocks{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ConvolutionReverb)
+};
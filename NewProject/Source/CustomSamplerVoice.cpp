@@ -1,21 +1,61 @@
 #include "CustomSamplerVoice.h"
 
-CustomSamplerVoice::CustomSamplerVoice()
+CustomSamplerVoice::CustomSamplerVoice(SampleStreamer& streamer, VoiceAllocator& voiceAllocator, int index)
+    : stream(streamer),
+      allocator(voiceAllocator),
+      voiceIndex(index),
+      window(static_cast<size_t>(std::ceil((windowChunk - 1) * maxStep)) + 2
+             + Resampler::maxTapsBefore + Resampler::maxTapsAfter + 2, 0.0f),
+      envelope(static_cast<size_t>(windowChunk), 0.0f),
+      voiceBuffer(static_cast<size_t>(windowChunk), 0.0f)
 {
 }
 
 bool CustomSamplerVoice::canPlaySound(juce::SynthesiserSound* sound)
 {
-    return dynamic_cast<juce::SamplerSound*>(sound) != nullptr;
+    return dynamic_cast<juce::SamplerSound*>(sound) != nullptr
+        || dynamic_cast<StreamingSamplerSound*>(sound) != nullptr;
 }
 
 void CustomSamplerVoice::startNote(int midiNoteNumber, float velocity,
     juce::SynthesiserSound* sound, int currentPitchWheelPosition)
 {
-    juce::SamplerVoice::startNote(midiNoteNumber, velocity, sound, currentPitchWheelPosition);
+    allocator.voiceStarted(voiceIndex, midiNoteNumber);
 
     noteOnTime = juce::Time::getMillisecondCounterHiRes();
     sourceSamplePosition = 0.0;
+    windowStart = -Resampler::maxTapsBefore;
+    windowSize = 0;
+    pendingSkip = 0;
+    quietSamples = 0;
+
+    playingSample = nullptr;
+
+    // A streaming sound plays the pool's copy at the host rate once it's been
+    // built, so the step below comes out at 1 and only bends need resampling
+    if (auto* streamingSound = dynamic_cast<StreamingSamplerSound*>(sound))
+    {
+        playingSample = streamingSound->getSample(getSampleRate());
+
+        if (playingSample == nullptr)
+        {
+            endNote();
+            return;
+        }
+
+        sourceSampleRate = playingSample->sampleRate;
+    }
+    else if (auto* inMemorySound = dynamic_cast<InMemorySamplerSound*>(sound))
+        sourceSampleRate = inMemorySound->getSourceSampleRate();
+
+    pitchWheelMoved(currentPitchWheelPosition);
+
+    // Ask for the part after the preload now, the preload covers the time the
+    // streaming thread needs to catch up
+    if (playingSample != nullptr && playingSample->length > playingSample->preloadLength)
+        stream.start(playingSample, playingSample->preloadLength);
+    else
+        stream.stop();
 
     float attack = juce::jmap(velocity, 0.0f, 1.0f, 0.1f, 0.01f);
 
@@ -39,58 +79,257 @@ void CustomSamplerVoice::stopNote(float velocity, bool allowTailOff)
     adsr.setParameters(adsrParams);
 
     adsr.noteOff();
+    allocator.voiceReleased(voiceIndex);
 
     if (!allowTailOff || !adsr.isActive())
-        clearCurrentNote();
+        endNote();
+}
+
+void CustomSamplerVoice::fadeOut() noexcept
+{
+    adsrParams.release = 0.005f;
+    adsr.setParameters(adsrParams);
+    adsr.noteOff();
+    allocator.voiceReleased(voiceIndex);
+}
+
+void CustomSamplerVoice::pitchWheelMoved(int newPitchWheelValue)
+{
+    // Full wheel travel is +/- 2 semitones, the same range as PITCH_BEND
+    wheelBend = 2.0f * static_cast<float>(newPitchWheelValue - 8192) / 8192.0f;
+    updateStep();
+}
+
+void CustomSamplerVoice::setPitchBend(float semitones) noexcept
+{
+    if (parameterBend != semitones)
+    {
+        parameterBend = semitones;
+        updateStep();
+    }
+}
+
+void CustomSamplerVoice::updateStep() noexcept
+{
+    const double hostRate = getSampleRate();
+    const double rateRatio = hostRate > 0.0 && sourceSampleRate > 0.0 ? sourceSampleRate / hostRate : 1.0;
+    const double bendRatio = std::pow(2.0, static_cast<double>(parameterBend + wheelBend) / 12.0);
+
+    step = juce::jlimit(1.0 / 64.0, maxStep, rateRatio * bendRatio);
+}
+
+void CustomSamplerVoice::endNote()
+{
+    stream.stop();
+    playingSample = nullptr;
+    clearCurrentNote();
+    allocator.voiceFinished(voiceIndex);
+}
+
+void CustomSamplerVoice::appendFromStream(float* destination, int numFrames)
+{
+    // Frames we had to fake during an underrun are still coming, drop them so
+    // the stream stays in step with sourceSamplePosition
+    if (pendingSkip > 0)
+        pendingSkip -= stream.skip(pendingSkip);
+
+    int numRead = pendingSkip > 0 ? 0 : stream.read(destination, numFrames);
+
+    // Rendering offline is allowed to block, so wait for the streaming thread
+    if (numRead < numFrames && pendingSkip == 0 && stream.getOwner().isNonRealtime())
+    {
+        const auto giveUpTime = juce::Time::getMillisecondCounter() + 2000;
+
+        while (numRead < numFrames && juce::Time::getMillisecondCounter() < giveUpTime)
+        {
+            juce::Thread::yield();
+            numRead += stream.read(destination + numRead, numFrames - numRead);
+        }
+    }
+
+    if (numRead < numFrames)
+    {
+        std::fill(destination + numRead, destination + numFrames, 0.0f);
+        pendingSkip += numFrames - numRead;
+        stream.getOwner().reportUnderrun(numFrames - numRead);
+    }
+}
+
+void CustomSamplerVoice::fillWindow(juce::SynthesiserSound& sound, juce::int64 from, juce::int64 to)
+{
+    // Drop what's behind the playhead (and its history taps)
+    const auto numBehind = static_cast<int>(juce::jlimit(static_cast<juce::int64>(0),
+                                                         static_cast<juce::int64>(windowSize),
+                                                         from - windowStart));
+    if (numBehind > 0)
+    {
+        std::copy(window.begin() + numBehind, window.begin() + windowSize, window.begin());
+        windowSize -= numBehind;
+        windowStart += numBehind;
+    }
+
+    auto nextFrame = windowStart + windowSize;
+    const auto numToAdd = static_cast<int>(to - nextFrame);
+
+    if (numToAdd <= 0)
+        return;
+
+    jassert(windowSize + numToAdd <= static_cast<int>(window.size()));
+    auto* destination = window.data() + windowSize;
+    windowSize += numToAdd;
+
+    juce::int64 length = 0;
+    auto* samplerSound = dynamic_cast<juce::SamplerSound*>(&sound);
+
+    if (playingSample != nullptr)
+        length = playingSample->length;
+    else if (samplerSound != nullptr)
+        length = samplerSound->getAudioData()->getNumSamples();
+
+    // History before the first frame
+    const int numBefore = static_cast<int>(juce::jlimit(static_cast<juce::int64>(0),
+                                                        static_cast<juce::int64>(numToAdd), -nextFrame));
+    std::fill(destination, destination + numBefore, 0.0f);
+    destination += numBefore;
+    nextFrame += numBefore;
+
+    const int numFrames = static_cast<int>(juce::jlimit(static_cast<juce::int64>(0),
+                                                        static_cast<juce::int64>(numToAdd - numBefore),
+                                                        length - nextFrame));
+
+    // Lookahead past the last frame
+    std::fill(destination + numFrames, destination + (numToAdd - numBefore), 0.0f);
+
+    if (numFrames <= 0)
+        return;
+
+    if (playingSample != nullptr)
+    {
+        const auto preloadLength = static_cast<juce::int64>(playingSample->preloadLength);
+        const int numFromPreload = static_cast<int>(juce::jlimit(static_cast<juce::int64>(0),
+                                                                 static_cast<juce::int64>(numFrames),
+                                                                 preloadLength - nextFrame));
+        if (numFromPreload > 0)
+            std::copy_n(playingSample->preload + nextFrame, numFromPreload, destination);
+
+        if (numFrames > numFromPreload)
+            appendFromStream(destination + numFromPreload, numFrames - numFromPreload);
+    }
+    else if (samplerSound != nullptr)
+    {
+        auto& data = *samplerSound->getAudioData();
+        const int numInputChannels = data.getNumChannels();
+        const auto offset = static_cast<int>(nextFrame);
+
+        juce::FloatVectorOperations::copy(destination, data.getReadPointer(0, offset), numFrames);
+
+        for (int channel = 1; channel < numInputChannels; ++channel)
+            juce::FloatVectorOperations::add(destination, data.getReadPointer(channel, offset), numFrames);
+
+        if (numInputChannels > 1)
+            juce::FloatVectorOperations::multiply(destination, 1.0f / static_cast<float>(numInputChannels), numFrames);
+    }
 }
 
 void CustomSamplerVoice::renderNextBlock(juce::AudioBuffer<float>& outputBuffer,
     int startSample, int numSamples)
 {
-    if (auto* playingSound = dynamic_cast<juce::SamplerSound*>(getCurrentlyPlayingSound().get()))
+    auto* playingSound = getCurrentlyPlayingSound().get();
+
+    if (playingSound == nullptr)
+        return;
+
+    juce::int64 totalLength = 0;
+
+    if (playingSample != nullptr)
+        totalLength = playingSample->length;
+    else if (auto* samplerSound = dynamic_cast<juce::SamplerSound*>(playingSound))
+        totalLength = samplerSound->getAudioData()->getNumSamples();
+    else
+        return;
+
+    const int numOutputChannels = outputBuffer.getNumChannels();
+    const auto quality = resamplerQuality;
+
+    for (int chunkStart = 0; chunkStart < numSamples; chunkStart += windowChunk)
     {
-        auto& data = *playingSound->getAudioData();
-        const int numInputChannels = data.getNumChannels();
-        const int totalLength = data.getNumSamples();
-        const int numOutputChannels = outputBuffer.getNumChannels();
+        int chunkLength = juce::jmin(windowChunk, numSamples - chunkStart);
+
+        // The sample runs out once the frame after the playhead is past the end,
+        // so work out up front how much of this chunk we can actually play
+        const double framesLeft = static_cast<double>(totalLength - 1) - sourceSamplePosition;
+        const auto playable = framesLeft > 0.0 ? static_cast<juce::int64>(std::ceil(framesLeft / step)) : 0;
+        const bool reachesEnd = playable < chunkLength;
 
-        for (int i = 0; i < numSamples; ++i)
+        if (reachesEnd)
+            chunkLength = static_cast<int>(playable);
+
+        if (chunkLength > 0)
         {
-            if (!adsr.isActive())
-            {
-                clearCurrentNote();
-                break;
-            }
+            // Every frame this chunk's kernel can touch, with a frame to spare for rounding
+            const auto firstFrame = static_cast<juce::int64>(sourceSamplePosition);
+            const auto lastFrame = static_cast<juce::int64>(sourceSamplePosition + (chunkLength - 1) * step);
+            fillWindow(*playingSound, firstFrame - Resampler::maxTapsBefore,
+                       lastFrame + Resampler::getTapsAfter(quality) + 2);
 
-            float envelopeValue = adsr.getNextSample();
-            int pos = static_cast<int>(sourceSamplePosition);
-            float alpha = static_cast<float>(sourceSamplePosition - pos);
-            int nextPos = pos + 1;
+            for (int i = 0; i < chunkLength; ++i)
+                envelope[static_cast<size_t>(i)] = adsr.getNextSample();
 
-            if (nextPos >= totalLength)
-            {
-                adsr.noteOff();
-                adsr.reset();
-                clearCurrentNote();
-                break;
-            }
+            const auto* frames = window.data() + (firstFrame - windowStart);
+            const double endPosition = Resampler::process(quality, frames,
+                sourceSamplePosition - static_cast<double>(firstFrame), step, voiceBuffer.data(), chunkLength);
+
+            juce::FloatVectorOperations::multiply(voiceBuffer.data(), envelope.data(), chunkLength);
+
+            // RMS picks the quietest voice to steal, the peak decides when it's inaudible
+            const auto range = juce::FloatVectorOperations::findMinAndMax(voiceBuffer.data(), chunkLength);
+            const float peak = juce::jmax(-range.getStart(), range.getEnd());
+            float sumOfSquares = 0.0f;
+
+            for (int i = 0; i < chunkLength; ++i)
+                sumOfSquares += voiceBuffer[static_cast<size_t>(i)] * voiceBuffer[static_cast<size_t>(i)];
+
+            allocator.setLevel(voiceIndex, std::sqrt(sumOfSquares / static_cast<float>(chunkLength)));
 
-            float inputSample = 0.0f;
-            for (int channel = 0; channel < numInputChannels; ++channel)
+            // Zeros faked for an underrun aren't the note going quiet, so a
+            // streaming hiccup neither counts towards culling nor resets it
+            if (pendingSkip == 0)
             {
-                auto* inData = data.getReadPointer(channel);
-                float sample = inData[pos] * (1.0f - alpha) + inData[nextPos] * alpha;
-                inputSample += sample;
+                if (peak < cullThreshold && envelope[static_cast<size_t>(chunkLength - 1)] <= envelope[0])
+                    quietSamples += chunkLength;
+                else
+                    quietSamples = 0;
             }
-            inputSample /= numInputChannels;
 
             for (int channel = 0; channel < numOutputChannels; ++channel)
-            {
-                auto* outData = outputBuffer.getWritePointer(channel, startSample);
-                outData[i] += inputSample * envelopeValue;
-            }
+                juce::FloatVectorOperations::add(outputBuffer.getWritePointer(channel, startSample + chunkStart),
+                                                 voiceBuffer.data(), chunkLength);
+
+            sourceSamplePosition = static_cast<double>(firstFrame) + endPosition;
+        }
 
-            sourceSamplePosition += 1.0;
+        if (reachesEnd)
+        {
+            adsr.noteOff();
+            adsr.reset();
+            endNote();
+            return;
+        }
+
+        // Once the release has finished the rest of the envelope is silence
+        if (!adsr.isActive())
+        {
+            endNote();
+            return;
+        }
+
+        // Decayed below anything audible (long samples sit at sustain for seconds)
+        if (cullThreshold > 0.0f && quietSamples >= juce::jmax(1, static_cast<int>(cullHoldSeconds * getSampleRate())))
+        {
+            allocator.voiceCulled();
+            adsr.reset();
+            endNote();
+            return;
         }
     }
 }
@@ -1,21 +1,101 @@
 #pragma once
 #include <JuceHeader.h>
+#include "SampleStreamer.h"
+#include "VoiceAllocator.h"
+#include "Resampler.h"
+
+// juce::SamplerSound keeps its source rate to itself, the voice needs it to
+// play at the right pitch on any host rate
+class InMemorySamplerSound : public juce::SamplerSound
+{
+public:
+    InMemorySamplerSound(const juce::String& soundName, juce::AudioFormatReader& source,
+        const juce::BigInteger& notes, int midiNoteForNormalPitch,
+        double attackTimeSecs, double releaseTimeSecs, double maxSampleLengthSeconds)
+        : juce::SamplerSound(soundName, source, notes, midiNoteForNormalPitch,
+                             attackTimeSecs, releaseTimeSecs, maxSampleLengthSeconds),
+          sourceSampleRate(source.sampleRate)
+    {
+    }
+
+    double getSourceSampleRate() const noexcept { return sourceSampleRate; }
+
+private:
+    double sourceSampleRate;
+};
 
 class CustomSamplerVoice : public juce::SamplerVoice
 {
 public:
-    CustomSamplerVoice();
+    CustomSamplerVoice(SampleStreamer& streamer, VoiceAllocator& allocator, int index);
 
     bool canPlaySound(juce::SynthesiserSound* sound) override;
     void startNote(int midiNoteNumber, float velocity,
         juce::SynthesiserSound* sound, int currentPitchWheelPosition) override;
     void stopNote(float velocity, bool allowTailOff) override;
+    void pitchWheelMoved(int newPitchWheelValue) override;
     void renderNextBlock(juce::AudioBuffer<float>& outputBuffer,
         int startSample, int numSamples) override;
 
+    // PITCH_BEND, in semitones. Added to the MIDI pitch wheel
+    void setPitchBend(float semitones) noexcept;
+    void setResamplerQuality(Resampler::Quality newQuality) noexcept { resamplerQuality = newQuality; }
+
+    // Output peak below which (for cullHoldSeconds, envelope not rising) the voice
+    // ends early. 0 keeps every voice until its envelope or sample runs out
+    void setCullThreshold(float gain) noexcept { cullThreshold = gain; }
+
+    static constexpr double cullHoldSeconds = 0.05;
+
+    // Releases over a few milliseconds instead of the note's own release, for
+    // voices the Synth needs back in a hurry
+    void fadeOut() noexcept;
+
+    // Highest playback speed, in source frames per output sample
+    static constexpr double maxStep = 4.0;
+
 private:
+    void endNote();
+    void updateStep() noexcept;
+
+    // Makes the source window hold mono frames [from, to) of the playing sound.
+    // Frames come from the sound's RAM (in-memory sounds and streaming preloads)
+    // or from the voice's stream, always in order. Frames before the start or
+    // past the end are silence
+    void fillWindow(juce::SynthesiserSound& sound, juce::int64 from, juce::int64 to);
+    void appendFromStream(float* destination, int numFrames);
+
     juce::ADSR adsr;
     juce::ADSR::Parameters adsrParams;
     double noteOnTime = 0.0;
     double sourceSamplePosition = 0.0;
+
+    // Source frames per output sample, from the rates and the bends
+    double step = 1.0;
+    double sourceSampleRate = 44100.0;
+    float parameterBend = 0.0f;
+    float wheelBend = 0.0f;
+    Resampler::Quality resamplerQuality = Resampler::Quality::sinc;
+
+    // For streaming sounds, the pool's copy this note is playing (native or
+    // already at the host rate). Fixed for the whole note
+    const SamplePool::Sample* playingSample = nullptr;
+
+    VoiceStream stream;
+    int pendingSkip = 0;
+
+    VoiceAllocator& allocator;
+    const int voiceIndex;
+
+    float cullThreshold = 0.0f;
+    int quietSamples = 0; // Rendered below cullThreshold in a row
+
+    static constexpr int windowChunk = 256;
+    std::vector<float> window;
+    juce::int64 windowStart = 0;
+    int windowSize = 0;
+
+    // Per-chunk envelope and voice output
+    std::vector<float> envelope;
+    std::vector<float> voiceBuffer;
 };
@@ -0,0 +1,155 @@
+/*
+  ==============================================================================
+
+    FDNMixer.h
+    Created: 18 Oct 2026 11:02:47am
+    Author:  mikey
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+#if JUCE_USE_SSE_INTRINSICS
+ #include <xmmintrin.h>
+#elif JUCE_USE_ARM_NEON
+ #include <arm_neon.h>
+#endif
+
+// Closed-form mixing kernels for the 16 FDN lines.
+// Both replace a dense 16x16 matrix-vector product:
+//  - hadamard():    normalised (1/4) Sylvester Hadamard, as a fast Walsh-Hadamard butterfly
+//  - householder(): I - (2/N) * 11^T, i.e. x - sum(x) / 8
+// The vector paths hold the 16 lines as a 4x4 tile in four registers, so the
+// Hadamard is H4 across registers, a transpose, H4 again and a transpose back.
+namespace FDNMixer
+{
+    static constexpr int numLines = 16;
+
+   #if JUCE_USE_SSE_INTRINSICS
+    inline void hadamard4(__m128& r0, __m128& r1, __m128& r2, __m128& r3) noexcept
+    {
+        const __m128 t0 = _mm_add_ps(r0, r1), t1 = _mm_sub_ps(r0, r1);
+        const __m128 t2 = _mm_add_ps(r2, r3), t3 = _mm_sub_ps(r2, r3);
+        r0 = _mm_add_ps(t0, t2);
+        r1 = _mm_add_ps(t1, t3);
+        r2 = _mm_sub_ps(t0, t2);
+        r3 = _mm_sub_ps(t1, t3);
+    }
+   #elif JUCE_USE_ARM_NEON
+    inline void hadamard4(float32x4_t& r0, float32x4_t& r1, float32x4_t& r2, float32x4_t& r3) noexcept
+    {
+        const float32x4_t t0 = vaddq_f32(r0, r1), t1 = vsubq_f32(r0, r1);
+        const float32x4_t t2 = vaddq_f32(r2, r3), t3 = vsubq_f32(r2, r3);
+        r0 = vaddq_f32(t0, t2);
+        r1 = vaddq_f32(t1, t3);
+        r2 = vsubq_f32(t0, t2);
+        r3 = vsubq_f32(t1, t3);
+    }
+
+    inline void transpose4(float32x4_t& r0, float32x4_t& r1, float32x4_t& r2, float32x4_t& r3) noexcept
+    {
+        const float32x4x2_t t01 = vtrnq_f32(r0, r1);
+        const float32x4x2_t t23 = vtrnq_f32(r2, r3);
+        r0 = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+        r1 = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+        r2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+        r3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+    }
+   #endif
+
+    // In-place normalised Hadamard mix of 16 lines
+    inline void hadamard(float* data) noexcept
+    {
+       #if JUCE_USE_SSE_INTRINSICS
+        __m128 r0 = _mm_loadu_ps(data), r1 = _mm_loadu_ps(data + 4);
+        __m128 r2 = _mm_loadu_ps(data + 8), r3 = _mm_loadu_ps(data + 12);
+
+        hadamard4(r0, r1, r2, r3);
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        hadamard4(r0, r1, r2, r3);
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+        const __m128 scale = _mm_set1_ps(0.25f);
+        _mm_storeu_ps(data, _mm_mul_ps(r0, scale));
+        _mm_storeu_ps(data + 4, _mm_mul_ps(r1, scale));
+        _mm_storeu_ps(data + 8, _mm_mul_ps(r2, scale));
+        _mm_storeu_ps(data + 12, _mm_mul_ps(r3, scale));
+       #elif JUCE_USE_ARM_NEON
+        float32x4_t r0 = vld1q_f32(data), r1 = vld1q_f32(data + 4);
+        float32x4_t r2 = vld1q_f32(data + 8), r3 = vld1q_f32(data + 12);
+
+        hadamard4(r0, r1, r2, r3);
+        transpose4(r0, r1, r2, r3);
+        hadamard4(r0, r1, r2, r3);
+        transpose4(r0, r1, r2, r3);
+
+        vst1q_f32(data, vmulq_n_f32(r0, 0.25f));
+        vst1q_f32(data + 4, vmulq_n_f32(r1, 0.25f));
+        vst1q_f32(data + 8, vmulq_n_f32(r2, 0.25f));
+        vst1q_f32(data + 12, vmulq_n_f32(r3, 0.25f));
+       #else
+        // Radix-2 butterflies, 64 adds
+        for (int len = 1; len < numLines; len <<= 1)
+        {
+            for (int i = 0; i < numLines; i += len << 1)
+            {
+                for (int j = i; j < i + len; ++j)
+                {
+                    const float a = data[j];
+                    const float b = data[j + len];
+                    data[j] = a + b;
+                    data[j + len] = a - b;
+                }
+            }
+        }
+
+        for (int i = 0; i < numLines; ++i)
+            data[i] *= 0.25f;
+       #endif
+    }
+
+    // In-place Householder reflection of 16 lines
+    inline void householder(float* data) noexcept
+    {
+        constexpr float twoOverN = 2.0f / numLines;
+
+       #if JUCE_USE_SSE_INTRINSICS
+        const __m128 r0 = _mm_loadu_ps(data), r1 = _mm_loadu_ps(data + 4);
+        const __m128 r2 = _mm_loadu_ps(data + 8), r3 = _mm_loadu_ps(data + 12);
+
+        // Horizontal sum, broadcast to all lanes
+        __m128 sum = _mm_add_ps(_mm_add_ps(r0, r1), _mm_add_ps(r2, r3));
+        sum = _mm_add_ps(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(2, 3, 0, 1)));
+        sum = _mm_add_ps(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 0, 3, 2)));
+
+        const __m128 offset = _mm_mul_ps(sum, _mm_set1_ps(twoOverN));
+        _mm_storeu_ps(data, _mm_sub_ps(r0, offset));
+        _mm_storeu_ps(data + 4, _mm_sub_ps(r1, offset));
+        _mm_storeu_ps(data + 8, _mm_sub_ps(r2, offset));
+        _mm_storeu_ps(data + 12, _mm_sub_ps(r3, offset));
+       #elif JUCE_USE_ARM_NEON
+        const float32x4_t r0 = vld1q_f32(data), r1 = vld1q_f32(data + 4);
+        const float32x4_t r2 = vld1q_f32(data + 8), r3 = vld1q_f32(data + 12);
+
+        const float32x4_t sum4 = vaddq_f32(vaddq_f32(r0, r1), vaddq_f32(r2, r3));
+        float32x2_t sum2 = vadd_f32(vget_low_f32(sum4), vget_high_f32(sum4));
+        sum2 = vpadd_f32(sum2, sum2);
+
+        const float32x4_t offset = vmulq_n_f32(vdupq_lane_f32(sum2, 0), twoOverN);
+        vst1q_f32(data, vsubq_f32(r0, offset));
+        vst1q_f32(data + 4, vsubq_f32(r1, offset));
+        vst1q_f32(data + 8, vsubq_f32(r2, offset));
+        vst1q_f32(data + 12, vsubq_f32(r3, offset));
+       #else
+        float sum = 0.0f;
+        for (int i = 0; i < numLines; ++i)
+            sum += data[i];
+
+        const float offset = sum * twoOverN;
+        for (int i = 0; i < numLines; ++i)
+            data[i] -= offset;
+       #endif
+    }
+}
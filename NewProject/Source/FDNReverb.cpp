@@ -13,183 +13,346 @@
 // AudioPluginHost set at 512 numSamples
 
 FDNReverb::FDNReverb() {
-	for (int i = 0; i < numDelayLines; ++i) {
-		delayLines.push_back(std::make_unique<CustomDelayLine>(primeDelays[i]));
-		diffusionFilters.push_back(AllPassFilter(allPassValues[i]));
-
-		// Modulated diffusers with different prime sizes
-		int modSize = allPassValues[i] * 1.23f;
-		if (modSize % 2 == 0) modSize++;
-		modulatedDiffusers.push_back(ModulatedAllPassFilter(modSize));
-
-		// Post-diffusion stage
-        modSize = allPassValues[i] * 1.5f;
-        if (modSize % 2 == 0) modSize++;
-		postDiffusers.push_back(AllPassFilter(modSize));
-
-		lpfFilters.push_back(BiquadFilter());
-		hpfFilters.push_back(BiquadFilter());
-		dcBlockers.push_back(DCBlocker());
-	}
-
 	// Different modulation rates for each diffuser
 	for (int i = 0; i < numDelayLines; ++i) {
 		float modRate = 0.1f + (0.3f * i / numDelayLines);
         float modDepth = 0.05f + (0.15f * i / numDelayLines);
-		modulatedDiffusers[i].setModulation(modDepth, modRate);
+		modulatedDiffusers.setModulation(i, modDepth, modRate);
 	}
 
 	// Early reflections
-	earlyReflections = {
-		{ 450,  0.65f },
-		{ 850,  0.57f },
-		{ 1250, 0.49f },
-		{ 1800, 0.40f },
-		{ 2500, 0.32f },
-		{ 3200, 0.24f },
-		{ 4000, 0.18f },
-		{ 4800, 0.15f },
-		{ 5400, 0.12f },
-		{ 6000, 0.10f },
-		{ 6500, 0.08f },
-		{ 7000, 0.07f },
-		{ 7500, 0.06f },
-		{ 8000, 0.05f },
-		{ 8500, 0.04f },
-		{ 9000, 0.03f }
-	};
+	earlyReflections.assign(std::begin(baseEarlyReflections), std::end(baseEarlyReflections));
 
 	// Initialize ER buffer
 	erBufferSize = 10000;
 	erBuffer.resize(erBufferSize, 0.0f);
 
-	// Additional diffusers for the early reflections
+	// Additional diffuser for the early reflections
 	erDiffusion1 = AllPassFilter();
-	erDiffusion2 = AllPassFilter();
 
-	predelayBuffer = PredelayLine(96000);
+	allocateLines(1.0);
 }
 
 FDNReverb::~FDNReverb() {
 }
 
-void FDNReverb::prepare(double newSampleRate) {
+void FDNReverb::allocateLines(double sampleRateRatio) {
+	// Delay lengths follow the sample rate, the diffusers don't
+	LineIndexArray delayLengths, diffusionLengths, modulatedLengths, postLengths;
+
+	for (int i = 0; i < numDelayLines; ++i) {
+		int scaledDelay = primeDelays[i];
+		if (std::abs(sampleRateRatio - 1.0) > 0.01)
+			scaledDelay = juce::jmax(1, static_cast<int>(primeDelays[i] * sampleRateRatio));
+		delayLengths[i] = scaledDelay;
+
+		diffusionLengths[i] = allPassValues[i];
+
+		// Modulated diffusers with different prime sizes
+		int modSize = allPassValues[i] * 1.23f;
+		if (modSize % 2 == 0) modSize++;
+		modulatedDiffusers.baseSize[i] = modSize;
+		modulatedDiffusers.currentSize[i] = modSize;
+		modulatedLengths[i] = modSize + LineModulatedAllPasses::modulationHeadroom;
+
+		// Post-diffusion stage
+        modSize = allPassValues[i] * 1.5f;
+        if (modSize % 2 == 0) modSize++;
+		postLengths[i] = modSize;
+	}
+
+	// One arena, each line's buffers laid out back to back
+	int offset = 0;
+	for (int i = 0; i < numDelayLines; ++i) {
+		delayLines.offset[i] = offset;
+		delayLines.length[i] = delayLengths[i];
+		offset += delayLengths[i];
+
+		diffusionFilters.offset[i] = offset;
+		diffusionFilters.length[i] = diffusionLengths[i];
+		offset += diffusionLengths[i];
+
+		modulatedDiffusers.offset[i] = offset;
+		modulatedDiffusers.length[i] = modulatedLengths[i];
+		offset += modulatedLengths[i];
+
+		postDiffusers.offset[i] = offset;
+		postDiffusers.length[i] = postLengths[i];
+		offset += postLengths[i];
+	}
+
+	lineArena.assign(static_cast<size_t>(offset), 0.0f);
+
+	delayLines.writeIndex.fill(0);
+	diffusionFilters.writeIndex.fill(0);
+	diffusionFilters.lastOutput.fill(0.0f);
+	modulatedDiffusers.writeIndex.fill(0);
+	modulatedDiffusers.lastOutput.fill(0.0f);
+	modulatedDiffusers.phase.fill(0.0f);
+	postDiffusers.writeIndex.fill(0);
+	postDiffusers.lastOutput.fill(0.0f);
+}
+
+void FDNReverb::prepare(double newSampleRate, int maxBlockSize) {
 	sampleRate = newSampleRate;
 
+	// Scratch buffers, process() must not resize anything
+	monoInput.assign(static_cast<size_t>(juce::jmax(1, maxBlockSize)), 0.0f);
+	earlyOutput.assign(static_cast<size_t>(juce::jmax(1, maxBlockSize)), 0.0f);
+	feedbackSignals.fill(0.0f);
+
+	// Same dither sequence on every render
+	ditherState = ditherSeed;
+
 	// Consistent reverb time across different sample rates
 	double sampleRateRatio = sampleRate / 44100.0;
 
-	if (std::abs(sampleRateRatio - 1.0) > 0.01) {
-		delayLines.clear();
-		for (int i = 0; i < numDelayLines; ++i) {
-			int scaledDelay = static_cast<int>(primeDelays[i] * sampleRateRatio);
-			if (scaledDelay < 1) scaledDelay = 1;
-			delayLines.push_back(std::make_unique<CustomDelayLine>(scaledDelay));
-		}
-	}
+	// Rebuild the delay and diffusion buffers
+	allocateLines(sampleRateRatio);
 
 	// Reset Biquad Filters
 	for (int i = 0; i < numDelayLines; ++i) {
-		lpfFilters[i].setLowpass(5000.0f, 0.7071f, static_cast<float>(sampleRate));
-		lpfFilters[i].z1 = 0.0f;
-		lpfFilters[i].z2 = 0.0f;
-
-		hpfFilters[i].setHighpass(120.0f, 0.7071f, static_cast<float>(sampleRate));
-		hpfFilters[i].z1 = 0.0f;
-		hpfFilters[i].z2 = 0.0f;
+		lpfFilters.setLowpass(i, 5000.0f, 0.7071f, static_cast<float>(sampleRate));
+		hpfFilters.setHighpass(i, 120.0f, 0.7071f, static_cast<float>(sampleRate));
 	}
+	lpfFilters.startRamp(0);
+	hpfFilters.startRamp(0);
+	lpfFilters.reset();
+	hpfFilters.reset();
 
-	// Reset diffusion filters
-	for (auto& filter : diffusionFilters) {
-		filter.clear();
-	}
+	// Force the first block to compute its own coefficients
+	currentHpCutoff = -1.0;
+	currentLpCutoff = -1.0;
+	coefficientRampSubBlocks = juce::jmax(1, static_cast<int>(coefficientRampSeconds * sampleRate / coefficientSubBlock + 0.5));
 
 	// Reset DC Blockers
-	for (auto& blocker : dcBlockers) {
-		blocker.reset();
-	}
+	dcBlockers.reset();
 
-	// Scale early reflection times for sample rate
-	for (auto& er : earlyReflections) {
-		er.delaySamples = static_cast<int>(er.delaySamples * sampleRateRatio);
-	}
+	for (auto& predelayLine : predelayBuffers)
+		predelayLine.clear();
 
-	// Reset modulated filters
-	for (auto& filter : modulatedDiffusers) {
-		filter.clear();
-	}
+	limiterOversampler.reset();
+	saturationOversampler.reset();
 
-	for (auto& filter : postDiffusers) {
-		filter.clear();
+	// Scale early reflection times for sample rate
+	for (int i = 0; i < numEarlyReflections; ++i) {
+		earlyReflections[i].delaySamples = static_cast<int>(baseEarlyReflections[i].delaySamples * sampleRateRatio);
 	}
 
 	// Resize and clear ER buffer
 	erBufferSize = static_cast<int>(10000 * sampleRateRatio);
-	erBuffer.resize(erBufferSize, 0.0f);
+	erBuffer.assign(erBufferSize, 0.0f);
+	erWriteIndex = 0;
+}
+
+void FDNReverb::reset() noexcept {
+	std::fill(lineArena.begin(), lineArena.end(), 0.0f);
+
+	delayLines.writeIndex.fill(0);
+	diffusionFilters.writeIndex.fill(0);
+	diffusionFilters.lastOutput.fill(0.0f);
+	modulatedDiffusers.writeIndex.fill(0);
+	modulatedDiffusers.lastOutput.fill(0.0f);
+	modulatedDiffusers.phase.fill(0.0f);
+	modulatedDiffusers.currentSize = modulatedDiffusers.baseSize;
+	postDiffusers.writeIndex.fill(0);
+	postDiffusers.lastOutput.fill(0.0f);
+
+	lpfFilters.reset();
+	hpfFilters.reset();
+	dcBlockers.reset();
+	feedbackSignals.fill(0.0f);
+
+	for (auto& predelayLine : predelayBuffers)
+		predelayLine.clear();
+
+	std::fill(erBuffer.begin(), erBuffer.end(), 0.0f);
 	erWriteIndex = 0;
+	erDiffusion1.clear();
+	ditherState = ditherSeed;
+
+	limiterOversampler.reset();
+	saturationOversampler.reset();
 }
 
-std::vector<std::vector<float>> FDNReverb::process(juce::AudioBuffer<float>& buffer,
+double FDNReverb::getTailSeconds(double sampleRate, double predelay, double decay) noexcept
+{
+	// Samples to silence after full-scale noise at 48kHz, by feedback gain, plus
+	// 25%. The gain is clamped like in process(), so DECAY over 0.98 rings no longer
+	constexpr std::array<std::pair<double, double>, 6> tailSamples{ {
+		{ 0.0, 10000.0 }, { 0.5, 45000.0 }, { 0.8, 90000.0 },
+		{ 0.9, 121000.0 }, { 0.95, 158000.0 }, { 0.98, 199000.0 } } };
+
+	const double gain = juce::jlimit(0.0, 0.98, decay);
+	double samples = tailSamples.back().second;
+
+	for (size_t i = 1; i < tailSamples.size(); ++i) {
+		if (gain <= tailSamples[i].first) {
+			const auto& below = tailSamples[i - 1];
+			const auto& above = tailSamples[i];
+			samples = below.second + (above.second - below.second) * (gain - below.first) / (above.first - below.first);
+			break;
+		}
+	}
+
+	// The filters and modulation are set in Hz, so the tail gets a little
+	// longer in samples as the rate goes up
+	samples *= std::sqrt(std::sqrt(sampleRate / 48000.0));
+
+	return juce::jmax(0.0, predelay) / 1000.0 + samples / sampleRate;
+}
+
+void FDNReverb::renderImpulseResponse(juce::AudioBuffer<float>& destination, double sampleRate,
+    double predelay, double decay, double diffusion, double hpCutoff, double lpCutoff)
+{
+	// Same block size as the live reverb gets in AudioPluginHost
+	constexpr int blockSize = 512;
+
+	// The feedback path gates lines under 1e-4, so a unit impulse dies out well
+	// before the tail music leaves, and soft limits over 0.4, which squashes the
+	// start of a louder one. The unit impulse's start is spliced onto a loud
+	// one's tail (scaled back) where the two agree
+	constexpr float tailImpulse = 8.0f;
+	constexpr double spliceStartSeconds = 0.15, spliceEndSeconds = 0.3;
+
+	auto render = [&](juce::AudioBuffer<float>& target, float impulse) {
+		auto reverb = std::make_unique<FDNReverb>();
+		reverb->prepare(sampleRate, blockSize);
+
+		juce::AudioBuffer<float> block(target.getNumChannels(), blockSize);
+
+		for (int start = 0; start < target.getNumSamples(); start += blockSize) {
+			const int numSamples = juce::jmin(blockSize, target.getNumSamples() - start);
+			block.setSize(target.getNumChannels(), numSamples, false, false, true);
+			block.clear();
+
+			if (start == 0)
+				for (int ch = 0; ch < block.getNumChannels(); ++ch)
+					block.setSample(ch, 0, impulse);
+
+			reverb->process(block, predelay, decay, diffusion, hpCutoff, lpCutoff);
+
+			for (int ch = 0; ch < block.getNumChannels(); ++ch)
+				target.copyFrom(ch, start, block, ch, 0, numSamples);
+		}
+	};
+
+	juce::AudioBuffer<float> tail(destination.getNumChannels(), destination.getNumSamples());
+	render(destination, 1.0f);
+	render(tail, tailImpulse);
+
+	const int spliceStart = juce::jmin(destination.getNumSamples(), static_cast<int>(spliceStartSeconds * sampleRate));
+	const int spliceEnd = juce::jmin(destination.getNumSamples(), static_cast<int>(spliceEndSeconds * sampleRate));
+
+	for (int ch = 0; ch < destination.getNumChannels(); ++ch) {
+		float* data = destination.getWritePointer(ch);
+		const float* loud = tail.getReadPointer(ch);
+
+		for (int i = spliceStart; i < destination.getNumSamples(); ++i) {
+			const float fade = i < spliceEnd ? static_cast<float>(i - spliceStart) / static_cast<float>(spliceEnd - spliceStart) : 1.0f;
+			data[i] += (loud[i] / tailImpulse - data[i]) * fade;
+		}
+	}
+}
+
+void FDNReverb::process(juce::AudioBuffer<float>& buffer,
     double predelay,
     double decay,
     double diffusion,
     double hpCutoff,
     double lpCutoff)
+{
+    // Two points a block apart, i.e. a flat ramp
+    const float predelayPoints[2] = { static_cast<float>(predelay), static_cast<float>(predelay) };
+    const float decayPoints[2] = { static_cast<float>(decay), static_cast<float>(decay) };
+    const float diffusionPoints[2] = { static_cast<float>(diffusion), static_cast<float>(diffusion) };
+
+    ControlPoints controls;
+    controls.predelay = predelayPoints;
+    controls.decay = decayPoints;
+    controls.diffusion = diffusionPoints;
+    controls.interval = juce::jmax(1, buffer.getNumSamples());
+
+    process(buffer, controls, hpCutoff, lpCutoff);
+}
+
+void FDNReverb::process(juce::AudioBuffer<float>& buffer,
+    const ControlPoints& controls,
+    double hpCutoff,
+    double lpCutoff)
 {
     const int numChannels = buffer.getNumChannels();
     const int numSamples = buffer.getNumSamples();
 
-    float decayGain = juce::jlimit(0.0f, 0.98f, static_cast<float>(decay));
+    // A new oversampling factor starts from clear filters, at a block boundary
+    const int factor = oversamplingFactor.load(std::memory_order_relaxed);
+    if (factor != saturationOversampler.getFactor()) {
+        limiterOversampler.setFactor(factor);
+        saturationOversampler.setFactor(factor);
+    }
+
+    tailDither = tailDitherEnabled.load(std::memory_order_relaxed);
+
+    // prepare() must have been called with a big enough block size
+    jassert(numSamples <= static_cast<int>(monoInput.size()));
+    jassert(controls.predelay != nullptr && controls.decay != nullptr && controls.diffusion != nullptr && controls.interval > 0);
+
     float decayVariations[numDelayLines] = {
         1.0f, 0.998f, 0.997f, 0.999f, 0.996f, 0.998f, 0.997f, 0.999f,
         0.995f, 0.998f, 0.996f, 0.999f, 0.997f, 0.995f, 0.998f, 0.996f
     };
-    float diffusionCoeff = juce::jlimit(0.0f, 0.9f, static_cast<float>(diffusion));
 
-    int predelaySamples = static_cast<int>(predelay * sampleRate / 1000.0);
+    // Parameters ramp from one control point to the next. They're clamped per
+    // point, so every value in between is in range too
+    const int controlInterval = controls.interval;
+    const float predelayToSamples = static_cast<float>(sampleRate / 1000.0);
+    ControlRate::Ramp predelayRamp, decayRamp, diffusionRamp;
 
     constexpr float butterworthQ = 0.7071f;
 
-    for (int i = 0; i < numDelayLines; ++i) {
-        // Add slight variation to cutoffs per delay line for more natural sound
-        float hpVariation = 0.95f + 0.1f * (static_cast<float>(i) / numDelayLines);
-        float lpVariation = 0.97f + 0.06f * (static_cast<float>(i) / numDelayLines);
-
-        hpfFilters[i].setHighpass(
-            static_cast<float>(hpCutoff) * hpVariation,
-            butterworthQ,
-            static_cast<float>(sampleRate)
-        );
-
-        lpfFilters[i].setLowpass(
-            static_cast<float>(lpCutoff) * lpVariation,
-            butterworthQ,
-            static_cast<float>(sampleRate)
-        );
+    // Coefficients are only recomputed when a cutoff actually moves, the first
+    // block after prepare() jumps straight to them and later changes ramp
+    if (hpCutoff != currentHpCutoff) {
+        for (int i = 0; i < numDelayLines; ++i) {
+            // Add slight variation to cutoffs per delay line for more natural sound
+            float hpVariation = 0.95f + 0.1f * (static_cast<float>(i) / numDelayLines);
+
+            hpfFilters.setHighpass(i,
+                static_cast<float>(hpCutoff) * hpVariation,
+                butterworthQ,
+                static_cast<float>(sampleRate)
+            );
+        }
+
+        hpfFilters.startRamp(currentHpCutoff < 0.0 ? 0 : coefficientRampSubBlocks);
+        currentHpCutoff = hpCutoff;
     }
 
-    std::vector<std::vector<float>> outputs(numDelayLines, std::vector<float>(numSamples, 0.0f));
-    std::vector<std::vector<float>> feedbackSignals(numDelayLines, std::vector<float>(numSamples, 0.0f));
-    std::vector<std::vector<float>> channelOutputs(numChannels, std::vector<float>(numSamples, 0.0f));
+    if (lpCutoff != currentLpCutoff) {
+        for (int i = 0; i < numDelayLines; ++i) {
+            float lpVariation = 0.97f + 0.06f * (static_cast<float>(i) / numDelayLines);
 
-    // Direct signal mix
-    for (int ch = 0; ch < numChannels; ++ch)
-    {
-        for (int sample = 0; sample < numSamples; ++sample)
-        {
-            channelOutputs[ch][sample] = buffer.getSample(ch, sample) * 0.20f;
+            lpfFilters.setLowpass(i,
+                static_cast<float>(lpCutoff) * lpVariation,
+                butterworthQ,
+                static_cast<float>(sampleRate)
+            );
         }
+
+        lpfFilters.startRamp(currentLpCutoff < 0.0 ? 0 : coefficientRampSubBlocks);
+        currentLpCutoff = lpCutoff;
     }
 
+    // Mono sum feeding the early reflections
+    juce::FloatVectorOperations::copy(monoInput.data(), buffer.getReadPointer(0), numSamples);
+    for (int ch = 1; ch < numChannels; ++ch)
+        juce::FloatVectorOperations::add(monoInput.data(), buffer.getReadPointer(ch), numSamples);
+    juce::FloatVectorOperations::multiply(monoInput.data(), 1.0f / numChannels, numSamples);
+
     // Early reflections
     for (int sample = 0; sample < numSamples; ++sample)
     {
-        float monoInput = 0.0f;
-        for (int ch = 0; ch < numChannels; ++ch)
-            monoInput += buffer.getSample(ch, sample);
-        monoInput /= numChannels;
-
-        erBuffer[erWriteIndex] = monoInput;
+        erBuffer[erWriteIndex] = monoInput[sample];
 
         float erOutput = 0.0f;
         for (int i = 0; i < 8; i++)
@@ -205,116 +368,153 @@ std::vector<std::vector<float>> FDNReverb::process(juce::AudioBuffer<float>& buf
 
         erWriteIndex = (erWriteIndex + 1) % erBufferSize;
 
-        for (int ch = 0; ch < numChannels; ++ch)
-            channelOutputs[ch][sample] += erOutput * 0.80f;
+        earlyOutput[sample] = erOutput * 0.80f;
     }
 
+    // Dry/wet ramps like the other parameters, no points means fully wet
+    ControlRate::Ramp dryWetRamp;
+    dryWetRamp.start(1.0f, 1.0f, 1);
+
+    float* arena = lineArena.data();
+
     for (int sample = 0; sample < numSamples; ++sample)
     {
-        std::array<float, numDelayLines> inputSignals = { 0.0f };
-        for (int ch = 0; ch < std::min(numChannels, numDelayLines); ++ch)
-        {
-            float inputSample = buffer.getSample(ch, sample);
-            inputSample = dcBlockers[ch].process(inputSample);
-            // Apply denormal prevention and then predelay
-            inputSignals[ch] = predelayBuffer.process(denormalPrevention(inputSample), predelaySamples);
+        // Step any running cutoff ramp once per sub-block
+        if ((sample % coefficientSubBlock) == 0) {
+            lpfFilters.advanceRamp();
+            hpfFilters.advanceRamp();
         }
 
-        std::array<float, numDelayLines> mixedInputs = { 0.0f };
-        for (int i = 0; i < numDelayLines; ++i)
-        {
-            for (int j = 0; j < numDelayLines; ++j)
-            {
-                mixedInputs[i] += hadamardMatrix[i][j] * inputSignals[j];
-            }
+        if ((sample % controlInterval) == 0) {
+            const int point = sample / controlInterval;
+
+            predelayRamp.start(juce::jmax(0.0f, controls.predelay[point]) * predelayToSamples,
+                juce::jmax(0.0f, controls.predelay[point + 1]) * predelayToSamples, controlInterval);
+            decayRamp.start(juce::jlimit(0.0f, 0.98f, controls.decay[point]),
+                juce::jlimit(0.0f, 0.98f, controls.decay[point + 1]), controlInterval);
+            diffusionRamp.start(juce::jlimit(0.0f, 0.9f, controls.diffusion[point]),
+                juce::jlimit(0.0f, 0.9f, controls.diffusion[point + 1]), controlInterval);
+
+            if (controls.dryWet != nullptr)
+                dryWetRamp.start(juce::jlimit(0.0f, 1.0f, controls.dryWet[point]),
+                    juce::jlimit(0.0f, 1.0f, controls.dryWet[point + 1]), controlInterval);
         }
 
-        // Start of feedback loop
-        for (int i = 0; i < numDelayLines; ++i)
-        {
-            float prevFeedback = (sample > 0) ? feedbackSignals[i][sample - 1] * 0.95f : 0.0f;
+        const float predelaySamples = predelayRamp.next();
+        const float decayGain = decayRamp.next();
+        const float diffusionCoeff = diffusionRamp.next();
+        const float dryWet = dryWetRamp.next();
 
-            // Invert polarity to increase complexity
-            bool invertInput = ((i & 0x1) != 0);
-            float delayInput = (invertInput ? -1.0f : 1.0f) * mixedInputs[i] + prevFeedback;
-            delayInput = lpfFilters[i].processBiquad(delayInput);
-            outputs[i][sample] = delayLines[i]->processSample(delayInput);
+        alignas(16) LineArray inputSignals = { 0.0f };
+        for (int ch = 0; ch < std::min(numChannels, numPredelayLines); ++ch)
+        {
+            float inputSample = buffer.getSample(ch, sample);
+            inputSample = dcBlockers.processLine(ch, inputSample);
+            // Apply denormal prevention and then predelay
+            inputSignals[ch] = predelayBuffers[ch].process(denormalPrevention(inputSample), predelaySamples);
         }
 
-        std::array<float, numDelayLines> householderMixed = { 0.0f };
+        FDNMixer::hadamard(inputSignals.data());
+
+        // Start of feedback loop, feedbackSignals still holds the previous sample here
+        alignas(16) LineArray lines;
+        const float feedbackGain = (sample > 0) ? 0.95f : 0.0f;
         for (int i = 0; i < numDelayLines; ++i)
         {
-            for (int j = 0; j < numDelayLines; ++j)
-                householderMixed[i] += householderMatrix[i][j] * outputs[j][sample];
+            // Invert polarity on odd lines to increase complexity
+            const float polarity = ((i & 0x1) != 0) ? -1.0f : 1.0f;
+            lines[i] = polarity * inputSignals[i] + feedbackSignals[i] * feedbackGain;
         }
 
+        lpfFilters.process(lines.data());
+        delayLines.process(arena, lines.data());
+
+        FDNMixer::householder(lines.data());
+
         // Noise gating with high-pass filtering and post diffusion
-        for (int i = 0; i < numDelayLines; ++i)
-        {
-            float signal = dcBlockers[i].process(householderMixed[i]);
+        dcBlockers.process(lines.data());
 
-            // HPF
-            signal = hpfFilters[i].processBiquad(signal);
+        // HPF
+        hpfFilters.process(lines.data());
 
-            signal = diffusionFilters[i].process(signal, 0.4f + (diffusionCoeff * 0.1f));
+        diffusionFilters.process(arena, lines.data(), 0.4f + (diffusionCoeff * 0.1f));
 
-			// Modulated diffusion with amplitude-sensitive depth
-            if (diffusionCoeff > 0.5f) {
-                float adaptiveDepth = (0.01f + (diffusionCoeff * 0.05f)) * std::min(1.0f, std::abs(signal) * 1.1f);
+        // Modulated diffusion with amplitude-sensitive depth
+        if (diffusionCoeff > 0.5f) {
+            alignas(16) LineArray adaptiveDepth;
+            for (int i = 0; i < numDelayLines; ++i)
+                adaptiveDepth[i] = (0.01f + (diffusionCoeff * 0.05f)) * std::min(1.0f, std::abs(lines[i]) * 1.1f);
 
-                // Apply modulated diffusion with amplitude-sensitive depth
-                signal = modulatedDiffusers[i].process(signal, adaptiveDepth, static_cast<float>(sampleRate));
-            }
+            modulatedDiffusers.process(arena, lines.data(), adaptiveDepth.data(), static_cast<float>(sampleRate));
+        }
 
-            float postDiffCoeff = 0.05f + (diffusionCoeff * 0.1f);
-            signal = postDiffusers[i].process(signal, postDiffCoeff);
+        float postDiffCoeff = 0.05f + (diffusionCoeff * 0.1f);
+        postDiffusers.process(arena, lines.data(), postDiffCoeff);
 
-            float lineDecay = decayGain * decayVariations[i];
+        // Saturating section: soft limit, noise gate, smoothing and tanh. The two
+        // static curves run oversampled when setOversampling() asks for it
+        for (int i = 0; i < numDelayLines; ++i)
+            lines[i] = denormalPrevention(lines[i]);
 
-            // Denormal prevention
-            signal = denormalPrevention(signal);
+        limiterOversampler.process(lines.data(), [](float* x) { FDNSaturation::softLimit(x); });
 
-            // Soft Limiting
-            signal = softLimit(signal);
+        alignas(16) LineArray lineDecays;
+        for (int i = 0; i < numDelayLines; ++i)
+        {
+            float signal = lines[i];
+            lineDecays[i] = decayGain * decayVariations[i];
 
             // Higher noise gate threshold
             if (std::abs(signal) < 1e-4f)
                 signal = 0.0f;
 
-            // More progressive noise reduction with additional soft threshold
-            if (std::abs(signal) < 5e-4f) {
-                signal *= std::pow(std::abs(signal) / 5e-4f, 1.5f);
-            }
+            // More progressive noise reduction with additional soft threshold,
+            // (|x| / 5e-4)^1.5 without the pow()
+            const float gateRatio = std::abs(signal) / 5e-4f;
+            if (gateRatio < 1.0f)
+                signal *= gateRatio * std::sqrt(gateRatio);
 
             if (sample > 0) {
-                float prevSample = feedbackSignals[i][sample - 1] / lineDecay;
+                float prevSample = feedbackSignals[i] / lineDecays[i];
                 signal = prevSample * 0.4f + signal * 0.6f;
             }
 
-            signal = std::tanh(signal * 0.9f) / 0.9f;
+            lines[i] = signal;
+        }
+
+        saturationOversampler.process(lines.data(), [](float* x) { FDNSaturation::tanh(x, 0.9f); });
+
+        for (int i = 0; i < numDelayLines; ++i)
+        {
+            float lineDecay = lineDecays[i];
 
             // Reduce decay for low frequencies
             if (i < 4) {
                 lineDecay *= 0.94f;
             }
 
-            feedbackSignals[i][sample] = signal * lineDecay;
+            feedbackSignals[i] = lines[i] * lineDecay;
         }
 
-        // Mix late reverb outputs for each channel
+        // Each channel takes its own set of lines, so the tail is decorrelated
+        // between them, and is mixed with the dry signal in place
         for (int ch = 0; ch < numChannels; ++ch)
         {
             float lateSum = 0.0f;
             for (int i = 0; i < numDelayLines; i += 2)
             {
                 float outputGain = 1.0f / (numDelayLines / 2);
-                lateSum += feedbackSignals[(i + ch) % numDelayLines][sample] * outputGain;
+                lateSum += feedbackSignals[(i + ch) % numDelayLines] * outputGain;
             }
-            channelOutputs[ch][sample] += lateSum;
-            channelOutputs[ch][sample] = softLimit(channelOutputs[ch][sample]);
+
+            auto* channelData = buffer.getWritePointer(ch);
+            const float drySample = channelData[sample];
+
+            // Direct signal mix, early reflections and the late tail
+            const float wetSample = FDNSaturation::softLimit(drySample * 0.20f + earlyOutput[sample] + lateSum);
+
+            channelData[sample] = dryWet < 1.0f ? drySample * (1.0f - dryWet) + wetSample * dryWet
+                                                : wetSample;
         }
     }
-
-    return channelOutputs;
 }
-
@@ -15,47 +15,45 @@
 #include <random>
 #include <iostream>
 #include <array>
-
-class CustomDelayLine {
-public:
-    CustomDelayLine(int delaySamples) : delaySamples(delaySamples) {
-        buffer.resize(delaySamples, 0.0f);
-    }
-
-    float processSample(float inputSample) {
-        float outputSample = buffer[writeIndex];
-        buffer[writeIndex] = inputSample;
-        writeIndex = (writeIndex + 1) % delaySamples;
-        return outputSample;
-    }
-
-private:
-    int delaySamples;
-    std::vector<float> buffer;
-    int writeIndex = 0;
-};
+#include "FDNMixer.h"
+#include "FDNSaturation.h"
+#include "ControlRate.h"
 
 class PredelayLine {
 public:
-    PredelayLine(int maxDelay) {
+    PredelayLine(int maxDelay = 96000) {
         buffer.resize(maxDelay, 0.0f);
     }
 
-    float process(float input, int delaySamples) {
-        delaySamples = juce::jlimit(0, static_cast<int>(buffer.size() - 1), delaySamples);
-
-        float output = buffer[readIndex];
+    // Fractional delay (linear interpolation), so a modulated predelay glides
+    // instead of jumping whole samples
+    float process(float input, float delaySamples) {
+        const int size = static_cast<int>(buffer.size());
         buffer[writeIndex] = input;
 
-        writeIndex = (writeIndex + 1) % buffer.size();
-        readIndex = (writeIndex - delaySamples + buffer.size()) % buffer.size();
+        const float delay = juce::jlimit(0.0f, static_cast<float>(size - 2), delaySamples);
+        const int wholeDelay = static_cast<int>(delay);
+        const float fraction = delay - static_cast<float>(wholeDelay);
+
+        int readIndex = writeIndex - wholeDelay;
+        if (readIndex < 0) readIndex += size;
+        int olderIndex = readIndex - 1;
+        if (olderIndex < 0) olderIndex += size;
+
+        if (++writeIndex == size)
+            writeIndex = 0;
+
+        return buffer[readIndex] + fraction * (buffer[olderIndex] - buffer[readIndex]);
+    }
 
-        return output;
+    void clear() noexcept {
+        std::fill(buffer.begin(), buffer.end(), 0.0f);
+        writeIndex = 0;
     }
 
 private:
     std::vector<float> buffer;
-    int writeIndex = 0, readIndex = 0;
+    int writeIndex = 0;
 };
 
 
@@ -65,61 +63,66 @@ public:
     FDNReverb();
     ~FDNReverb();
 
-    std::vector<std::vector<float>> FDNReverb::process(juce::AudioBuffer<float>& buffer, double predelay, double decay, double diffusion, double hpCutoff, double lpCutoff);
-    void prepare(double newSampleRate);
+    // Predelay (ms), decay, diffusion and dry/wet at control rate (see ControlRate.h):
+    // each array holds ControlRate::getNumPoints(numSamples, interval) values
+    // and process() ramps between them sample by sample. No dry/wet is fully wet
+    struct ControlPoints {
+        const float* predelay = nullptr;
+        const float* decay = nullptr;
+        const float* diffusion = nullptr;
+        const float* dryWet = nullptr;
+        int interval = ControlRate::defaultInterval;
+    };
+
+    // Adds the reverb to 'buffer' in place: every channel gets its own late
+    // taps, and dry/wet is mixed in the same pass.
+    // Doesn't allocate, all scratch memory is sized in prepare()
+    void process(juce::AudioBuffer<float>& buffer, const ControlPoints& controls, double hpCutoff, double lpCutoff);
+
+    // Same, fully wet, with the parameters held for the whole block
+    void process(juce::AudioBuffer<float>& buffer, double predelay, double decay, double diffusion, double hpCutoff, double lpCutoff);
+    void prepare(double newSampleRate, int maxBlockSize);
+
+    // Clears the tail without reallocating, safe on the audio thread
+    void reset() noexcept;
+
+    // The response to an impulse with the parameters held, fully wet, into
+    // every channel of 'destination' (its length is the render's). A fresh
+    // instance does the work, so any thread but the audio thread can call it.
+    // The feedback path isn't linear at the extremes, so this is an estimate
+    // at the levels music plays it at
+    static void renderImpulseResponse(juce::AudioBuffer<float>& destination, double sampleRate,
+        double predelay, double decay, double diffusion, double hpCutoff, double lpCutoff);
+
+    // How long the tail rings on (down to -100 dBFS) once loud input stops,
+    // measured at the worst-case diffusion with some margin. The delay lines are
+    // fixed in samples, so it's shorter at higher rates
+    static double getTailSeconds(double sampleRate, double predelay, double decay) noexcept;
+
+    // Optional noise floor injected into the near-silent tail instead of zeros
+    void setTailDither(bool shouldDither) noexcept { tailDitherEnabled.store(shouldDither, std::memory_order_relaxed); }
+
+    // Runs the feedback path's soft limiter and tanh at 1x (default), 2x or 4x
+    // the sample rate, so their harmonics don't alias. Takes effect at the next block
+    void setOversampling(int factor) noexcept { oversamplingFactor.store(factor, std::memory_order_relaxed); }
+    int getOversampling() const noexcept { return oversamplingFactor.load(std::memory_order_relaxed); }
 
 private:
-    // DelayLines
-    std::vector<std::unique_ptr<CustomDelayLine>> delayLines;
     static constexpr int numDelayLines = 16;
     const int primeDelays[numDelayLines] = {
         83, 89, 97, 101, 103, 109, 113, 121,
         127, 131, 137, 139, 149, 151, 157, 163
     };
 
-    PredelayLine predelayBuffer{ 96000 }; // Maximum 2 seconds at 48kHz 
-
-    // Normalised Hadamard matrix
-    std::vector<std::vector<float>> FDNReverb::hadamard(const std::vector<std::vector<float>>& delayOutputs);
-    const std::array<std::array<float, numDelayLines>, numDelayLines> hadamardMatrix = { {
-        {  0.25f,  0.25f,  0.25f,  0.25f,  0.25f,  0.25f,  0.25f,  0.25f,  0.25f,  0.25f,  0.25f,  0.25f,  0.25f,  0.25f,  0.25f,  0.25f },
-        {  0.25f, -0.25f,  0.25f, -0.25f,  0.25f, -0.25f,  0.25f, -0.25f,  0.25f, -0.25f,  0.25f, -0.25f,  0.25f, -0.25f,  0.25f, -0.25f },
-        {  0.25f,  0.25f, -0.25f, -0.25f,  0.25f,  0.25f, -0.25f, -0.25f,  0.25f,  0.25f, -0.25f, -0.25f,  0.25f,  0.25f, -0.25f, -0.25f },
-        {  0.25f, -0.25f, -0.25f,  0.25f,  0.25f, -0.25f, -0.25f,  0.25f,  0.25f, -0.25f, -0.25f,  0.25f,  0.25f, -0.25f, -0.25f,  0.25f },
-        {  0.25f,  0.25f,  0.25f,  0.25f, -0.25f, -0.25f, -0.25f, -0.25f,  0.25f,  0.25f,  0.25f,  0.25f, -0.25f, -0.25f, -0.25f, -0.25f },
-        {  0.25f, -0.25f,  0.25f, -0.25f, -0.25f,  0.25f, -0.25f,  0.25f,  0.25f, -0.25f,  0.25f, -0.25f, -0.25f,  0.25f, -0.25f,  0.25f },
-        {  0.25f,  0.25f, -0.25f, -0.25f, -0.25f, -0.25f,  0.25f,  0.25f,  0.25f,  0.25f, -0.25f, -0.25f, -0.25f, -0.25f,  0.25f,  0.25f },
-        {  0.25f, -0.25f, -0.25f,  0.25f, -0.25f,  0.25f,  0.25f, -0.25f,  0.25f, -0.25f, -0.25f,  0.25f, -0.25f,  0.25f,  0.25f, -0.25f },
-        {  0.25f,  0.25f,  0.25f,  0.25f,  0.25f,  0.25f,  0.25f,  0.25f, -0.25f, -0.25f, -0.25f, -0.25f, -0.25f, -0.25f, -0.25f, -0.25f },
-        {  0.25f, -0.25f,  0.25f, -0.25f,  0.25f, -0.25f,  0.25f, -0.25f, -0.25f,  0.25f, -0.25f,  0.25f, -0.25f,  0.25f, -0.25f,  0.25f },
-        {  0.25f,  0.25f, -0.25f, -0.25f,  0.25f,  0.25f, -0.25f, -0.25f, -0.25f, -0.25f,  0.25f,  0.25f, -0.25f, -0.25f,  0.25f,  0.25f },
-        {  0.25f, -0.25f, -0.25f,  0.25f,  0.25f, -0.25f, -0.25f,  0.25f, -0.25f,  0.25f,  0.25f, -0.25f, -0.25f,  0.25f,  0.25f, -0.25f },
-        {  0.25f,  0.25f,  0.25f,  0.25f, -0.25f, -0.25f, -0.25f, -0.25f, -0.25f, -0.25f, -0.25f, -0.25f,  0.25f,  0.25f,  0.25f,  0.25f },
-        {  0.25f, -0.25f,  0.25f, -0.25f, -0.25f,  0.25f, -0.25f,  0.25f, -0.25f,  0.25f, -0.25f,  0.25f,  0.25f, -0.25f,  0.25f, -0.25f },
-        {  0.25f,  0.25f, -0.25f, -0.25f, -0.25f, -0.25f,  0.25f,  0.25f, -0.25f, -0.25f,  0.25f,  0.25f,  0.25f,  0.25f, -0.25f, -0.25f },
-        {  0.25f, -0.25f, -0.25f,  0.25f, -0.25f,  0.25f,  0.25f, -0.25f, -0.25f,  0.25f,  0.25f, -0.25f,  0.25f, -0.25f, -0.25f,  0.25f }
-    } };
-
-	// Normalised Householder matrix
-    const std::array<std::array<float, numDelayLines>, numDelayLines> householderMatrix = { {
-        {  0.875f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f },
-        { -0.125f,  0.875f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f },
-        { -0.125f, -0.125f,  0.875f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f },
-        { -0.125f, -0.125f, -0.125f,  0.875f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f },
-        { -0.125f, -0.125f, -0.125f, -0.125f,  0.875f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f },
-        { -0.125f, -0.125f, -0.125f, -0.125f, -0.125f,  0.875f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f },
-        { -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f,  0.875f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f },
-        { -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f,  0.875f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f },
-        { -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f,  0.875f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f },
-        { -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f,  0.875f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f },
-        { -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f,  0.875f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f },
-        { -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f,  0.875f, -0.125f, -0.125f, -0.125f, -0.125f },
-        { -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f,  0.875f, -0.125f, -0.125f, -0.125f },
-        { -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f,  0.875f, -0.125f, -0.125f },
-        { -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f,  0.875f, -0.125f },
-        { -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f, -0.125f,  0.875f }
-    } };
+    // One per input channel, so left and right aren't interleaved in one line.
+    // Maximum 2 seconds at 48kHz
+    static constexpr int numPredelayLines = 2;
+    std::array<PredelayLine, numPredelayLines> predelayBuffers;
 
+    // Hadamard (input diffusion) and Householder (feedback) mixing run through
+    // the closed-form kernels in FDNMixer.h rather than dense 16x16 matrices
+
+    // Single all-pass, only used to diffuse the early reflections
     struct AllPassFilter {
         std::vector<float> buffer;
         int bufferSize = 0;
@@ -139,7 +142,6 @@ private:
             int readIndex = (writeIndex - bufferSize + static_cast<int>(buffer.size())) % static_cast<int>(buffer.size());
             float delayedSample = buffer[readIndex];
 
-            // Apply cascade of two first-order all-pass sections
             float temp = input + (coeff * delayedSample);
             buffer[writeIndex] = temp;
             writeIndex = (writeIndex + 1) % buffer.size();
@@ -152,18 +154,11 @@ private:
 
             // Soft saturation to reduce peaks which cause distortion
             if (std::abs(output) > 0.9f)
-                output = std::tanh(output);
+                output = FDNSaturation::tanh(output);
 
             return output;
         }
 
-		// Cascaded diffusion with two stages
-        float processMultiStage(float input, float coeff) {
-            float stage1 = process(input, coeff);
-            float stage2 = process(stage1, coeff * 0.85f);
-            return stage2;
-        }
-
         // Reset the filter states
         void clear() noexcept {
             std::fill(buffer.begin(), buffer.end(), 0.0f);
@@ -172,165 +167,310 @@ private:
         }
     };
 
-    struct ModulatedAllPassFilter {
-        std::vector<float> buffer;
-        int baseSize;
-        int currentSize;
-        int writeIndex = 0;
-        float phase = 0.0f;
-        float modDepth = 0.0f;
-        float modRate = 0.0f;
-        float lastOutput = 0.0f;
+    //==============================================================================
+    // Per-line state, stored as structure-of-arrays: every field holds one value
+    // per delay line, so each stage runs as a single pass over all 16 lines.
+    // Delay and all-pass buffers all live in one arena (lineArena), addressed by
+    // per-line offsets.
+    using LineArray = std::array<float, numDelayLines>;
+    using LineIndexArray = std::array<int, numDelayLines>;
+
+    // Biquad filter: 2 poles and 2 zeros, one per line.
+    // setLowpass/setHighpass only compute a target set, startRamp() then moves the
+    // live coefficients there linearly over a number of sub-blocks. Interpolating
+    // between two stable biquads keeps (a1, a2) inside the stability triangle
+    struct LineBiquads {
+        struct Coefficients {
+            alignas(16) LineArray b0, b1, b2, a1, a2;
+        };
+
+        Coefficients coeffs, target, step;
+        alignas(16) LineArray z1, z2;
+        int rampSubBlocksLeft = 0;
+
+        LineBiquads() {
+            coeffs.b0.fill(1.0f);
+            coeffs.b1.fill(0.0f); coeffs.b2.fill(0.0f);
+            coeffs.a1.fill(0.0f); coeffs.a2.fill(0.0f);
+            target = coeffs;
+            step = {};
+            reset();
+        }
 
-        ModulatedAllPassFilter(int size = 433) {
-            baseSize = size;
-            currentSize = size;
-            // Extra buffer space for modulation
-            buffer.resize(size + 100, 0.0f);
+        // Transposed direct form II across all lines
+        void process(float* x) noexcept {
+            for (int i = 0; i < numDelayLines; ++i) {
+                const float in = x[i];
+                const float out = in * coeffs.b0[i] + z1[i];
+                z1[i] = in * coeffs.b1[i] + z2[i] - coeffs.a1[i] * out;
+                z2[i] = in * coeffs.b2[i] - coeffs.a2[i] * out;
+                x[i] = out;
+            }
         }
 
-        float process(float input, float coeff, float sampleRate) {
-            coeff = juce::jlimit(-0.9f, 0.9f, coeff);
+        // Target coefficients for low-pass filter
+        void setLowpass(int line, float frequency, float q, float sampleRate) noexcept {
+            float omega = 2.0f * juce::MathConstants<float>::pi * frequency / sampleRate;
+            float alpha = std::sin(omega) / (2.0f * q);
+            float cosw = std::cos(omega);
 
-            // Update modulation with smoother transitions
-            float prevPhase = phase;
-            phase += modRate / sampleRate;
-            if (phase >= 1.0f) phase -= 1.0f;
+            float norm = 1.0f / (1.0f + alpha);
 
-            // Cosine interpolation for smooth transitions
-            float t = (phase < prevPhase) ? 0.0f : phase;
-            float modFactor = 1.0f + modDepth * std::sin(t * 2.0f * juce::MathConstants<float>::pi);
+            target.b0[line] = ((1.0f - cosw) * 0.5f) * norm;
+            target.b1[line] = (1.0f - cosw) * norm;
+            target.b2[line] = ((1.0f - cosw) * 0.5f) * norm;
+            target.a1[line] = (-2.0f * cosw) * norm;
+            target.a2[line] = (1.0f - alpha) * norm;
+        }
 
-            // Limit modulation per sample
-            int targetSize = static_cast<int>(baseSize * modFactor);
-            if (targetSize >= (int)buffer.size()) targetSize = buffer.size() - 1;
-            if (targetSize < 1) targetSize = 1;
+        // Target coefficients for high-pass filter
+        void setHighpass(int line, float frequency, float q, float sampleRate) noexcept {
+            float omega = 2.0f * juce::MathConstants<float>::pi * frequency / sampleRate;
+            float alpha = std::sin(omega) / (2.0f * q);
+            float cosw = std::cos(omega);
 
-            // Smooth buffer size transitions
-            currentSize = currentSize * 0.99f + targetSize * 0.01f;
-            int usedSize = static_cast<int>(currentSize);
+            float norm = 1.0f / (1.0f + alpha);
 
-            // Processing with modulated delay
-            int readIndex = (writeIndex - usedSize + static_cast<int>(buffer.size())) % static_cast<int>(buffer.size());
-            float delayedSample = buffer[readIndex];
+            target.b0[line] = ((1.0f + cosw) * 0.5f) * norm;
+            target.b1[line] = -(1.0f + cosw) * norm;
+            target.b2[line] = ((1.0f + cosw) * 0.5f) * norm;
+            target.a1[line] = (-2.0f * cosw) * norm;
+            target.a2[line] = (1.0f - alpha) * norm;
+        }
 
-            float temp = input + (coeff * delayedSample);
-            buffer[writeIndex] = temp;
-            writeIndex = (writeIndex + 1) % buffer.size();
+        // Head for the target over numSubBlocks calls to advanceRamp(), or jump there if 0
+        void startRamp(int numSubBlocks) noexcept {
+            if (numSubBlocks <= 0) {
+                coeffs = target;
+                rampSubBlocksLeft = 0;
+                return;
+            }
+
+            const float scale = 1.0f / numSubBlocks;
+            for (int i = 0; i < numDelayLines; ++i) {
+                step.b0[i] = (target.b0[i] - coeffs.b0[i]) * scale;
+                step.b1[i] = (target.b1[i] - coeffs.b1[i]) * scale;
+                step.b2[i] = (target.b2[i] - coeffs.b2[i]) * scale;
+                step.a1[i] = (target.a1[i] - coeffs.a1[i]) * scale;
+                step.a2[i] = (target.a2[i] - coeffs.a2[i]) * scale;
+            }
+            rampSubBlocksLeft = numSubBlocks;
+        }
 
-            float output = delayedSample - (coeff * temp);
+        // Called once per sub-block
+        void advanceRamp() noexcept {
+            if (rampSubBlocksLeft == 0)
+                return;
+
+            // Land exactly on the target at the end of the ramp
+            if (--rampSubBlocksLeft == 0) {
+                coeffs = target;
+                return;
+            }
+
+            for (int i = 0; i < numDelayLines; ++i) {
+                coeffs.b0[i] += step.b0[i];
+                coeffs.b1[i] += step.b1[i];
+                coeffs.b2[i] += step.b2[i];
+                coeffs.a1[i] += step.a1[i];
+                coeffs.a2[i] += step.a2[i];
+            }
+        }
 
-            // Smooth transitions
-            output = 0.92f * output + 0.08f * lastOutput;
-            lastOutput = output;
+        // Reset filter state
+        void reset() noexcept {
+            z1.fill(0.0f);
+            z2.fill(0.0f);
+        }
+    };
 
-            return output;
+    // Avoid DC Bias, one second-order blocker per line
+    struct LineDCBlockers {
+        // Pole at 0.995, zero at 1.0
+        static constexpr float R = 0.995f;
+
+        alignas(16) LineArray x1{}, x2{}, y1{}, y2{};
+
+        void reset() noexcept {
+            x1.fill(0.0f); x2.fill(0.0f);
+            y1.fill(0.0f); y2.fill(0.0f);
         }
 
-        void setModulation(float depth, float rate) {
-			// Ensure parameters are in the range
-            modDepth = juce::jlimit(0.0f, 0.3f, depth);
-            modRate = juce::jlimit(0.01f, 8.0f, rate);
+        // y[n] = x[n] - x[n-2] + R^2 * y[n-2]
+        float processLine(int i, float input) noexcept {
+            float output = input - x2[i] + R * R * y2[i];
+
+            x2[i] = x1[i];
+            x1[i] = input;
+            y2[i] = y1[i];
+            y1[i] = output;
+
+            return output;
         }
 
-        void clear() noexcept {
-            std::fill(buffer.begin(), buffer.end(), 0.0f);
-            writeIndex = 0;
-            lastOutput = 0.0f;
-            phase = 0.0f;
+        void process(float* x) noexcept {
+            for (int i = 0; i < numDelayLines; ++i)
+                x[i] = processLine(i, x[i]);
         }
     };
 
-    const int allPassValues[16] = { 97, 109, 127, 139, 193, 251, 311, 373, 433, 491, 659, 619, 683, 757, 827, 887 };
-    std::vector<AllPassFilter> diffusionFilters;
-    std::vector<ModulatedAllPassFilter> modulatedDiffusers;
-    std::vector<AllPassFilter> postDiffusers;
-
-    // Biquad filter: 2 poles and 2 zeros
-    struct BiquadFilter {
-        float lastInput = 0.0f;
-        float cutoffFreq = 5000.0f;
-        // Q factor -> Butterworth
-        float q = 0.7071f;
-
-        // First stage
-        float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f;
-        float a1 = 0.0f, a2 = 0.0f;
-        float z1 = 0.0f, z2 = 0.0f;
-
-        // Second stage 
-        float b0_2 = 1.0f, b1_2 = 0.0f, b2_2 = 0.0f;
-        float a1_2 = 0.0f, a2_2 = 0.0f;
-        float z1_2 = 0.0f, z2_2 = 0.0f;
-
-        // Process (24dB/octave)
-        float processBiquad(float in) {
-            // First stage
-            float mid = in * b0 + z1;
-            z1 = in * b1 + z2 - a1 * mid;
-            z2 = in * b2 - a2 * mid;
-
-            // Second stage
-            float out = mid * b0_2 + z1_2;
-            z1_2 = mid * b1_2 + z2_2 - a1_2 * out;
-            z2_2 = mid * b2_2 - a2_2 * out;
-
-            return out;
+    // Plain circular delays, one per line
+    struct LineDelays {
+        LineIndexArray offset{}, length{}, writeIndex{};
+
+        void process(float* arena, float* x) noexcept {
+            for (int i = 0; i < numDelayLines; ++i) {
+                float* slot = arena + offset[i] + writeIndex[i];
+                const float delayed = *slot;
+                *slot = x[i];
+                x[i] = delayed;
+                if (++writeIndex[i] == length[i])
+                    writeIndex[i] = 0;
+            }
         }
+    };
 
-        // Coefficients for low-pass filter
-        void setLowpass(float frequency, float q, float sampleRate) {
-            cutoffFreq = frequency;
-            this->q = q;
+    // Fixed all-pass diffusers, one per line
+    struct LineAllPasses {
+        LineIndexArray offset{}, length{}, writeIndex{};
+        // Use the last output for smoother transitions (and avoid clipping)
+        alignas(16) LineArray lastOutput{};
 
-            float omega = 2.0f * juce::MathConstants<float>::pi * frequency / sampleRate;
-            float alpha = std::sin(omega) / (2.0f * q);
-            float cosw = std::cos(omega);
+        void process(float* arena, float* x, float coeff) noexcept {
+            coeff = juce::jlimit(-0.9f, 0.9f, coeff);
 
-            float norm = 1.0f / (1.0f + alpha);
+            for (int i = 0; i < numDelayLines; ++i) {
+                float* slot = arena + offset[i] + writeIndex[i];
+                const float delayedSample = *slot;
+
+                const float temp = x[i] + (coeff * delayedSample);
+                *slot = temp;
+                if (++writeIndex[i] == length[i])
+                    writeIndex[i] = 0;
+
+                float output = delayedSample - (coeff * temp);
 
-            b0 = ((1.0f - cosw) * 0.5f) * norm;
-            b1 = (1.0f - cosw) * norm;
-            b2 = ((1.0f - cosw) * 0.5f) * norm;
-            a1 = (-2.0f * cosw) * norm;
-            a2 = (1.0f - alpha) * norm;
+                // Smooth transitions to reduce THD
+                output = 0.85f * output + 0.15f * lastOutput[i];
+                lastOutput[i] = output;
+
+                // Soft saturation to reduce peaks which cause distortion
+                if (std::abs(output) > 0.9f)
+                    output = FDNSaturation::tanh(output);
+
+                x[i] = output;
+            }
         }
+    };
 
-        // Coefficients for high-pass filter
-        void setHighpass(float frequency, float q, float sampleRate) {
-            cutoffFreq = frequency;
-            this->q = q;
+    // All-pass diffusers with a slowly modulated length, one per line.
+    // The buffer has 100 samples of headroom over the base length for the modulation
+    struct LineModulatedAllPasses {
+        static constexpr int modulationHeadroom = 100;
 
-            float omega = 2.0f * juce::MathConstants<float>::pi * frequency / sampleRate;
-            float alpha = std::sin(omega) / (2.0f * q);
-            float cosw = std::cos(omega);
+        LineIndexArray offset{}, length{}, writeIndex{};
+        LineIndexArray baseSize{}, currentSize{};
+        alignas(16) LineArray phase{}, modDepth{}, modRate{}, lastOutput{};
 
-            float norm = 1.0f / (1.0f + alpha);
+        // coeff is per line (amplitude-sensitive depth)
+        void process(float* arena, float* x, const float* coeff, float sampleRate) noexcept {
+            for (int i = 0; i < numDelayLines; ++i) {
+                const float c = juce::jlimit(-0.9f, 0.9f, coeff[i]);
+
+                // Update modulation with smoother transitions
+                float prevPhase = phase[i];
+                phase[i] += modRate[i] / sampleRate;
+                if (phase[i] >= 1.0f) phase[i] -= 1.0f;
+
+                float t = (phase[i] < prevPhase) ? 0.0f : phase[i];
+                float modFactor = 1.0f + modDepth[i] * std::sin(t * 2.0f * juce::MathConstants<float>::pi);
+
+                // Limit modulation per sample
+                int targetSize = static_cast<int>(baseSize[i] * modFactor);
+                if (targetSize >= length[i]) targetSize = length[i] - 1;
+                if (targetSize < 1) targetSize = 1;
+
+                // Smooth buffer size transitions
+                currentSize[i] = static_cast<int>(currentSize[i] * 0.99f + targetSize * 0.01f);
+                const int usedSize = currentSize[i];
+
+                // Processing with modulated delay
+                const int readIndex = (writeIndex[i] - usedSize + length[i]) % length[i];
+                float* buffer = arena + offset[i];
+                const float delayedSample = buffer[readIndex];
+
+                const float temp = x[i] + (c * delayedSample);
+                buffer[writeIndex[i]] = temp;
+                if (++writeIndex[i] == length[i])
+                    writeIndex[i] = 0;
+
+                float output = delayedSample - (c * temp);
 
-            b0 = ((1.0f + cosw) * 0.5f) * norm;
-            b1 = -(1.0f + cosw) * norm;
-            b2 = ((1.0f + cosw) * 0.5f) * norm;
-            a1 = (-2.0f * cosw) * norm;
-            a2 = (1.0f - alpha) * norm;
+                // Smooth transitions
+                output = 0.92f * output + 0.08f * lastOutput[i];
+                lastOutput[i] = output;
+
+                x[i] = output;
+            }
         }
 
-        // Reset filter state
-        void reset() {
-            z1 = z2 = 0.0f;
+        void setModulation(int line, float depth, float rate) noexcept {
+            // Ensure parameters are in the range
+            modDepth[line] = juce::jlimit(0.0f, 0.3f, depth);
+            modRate[line] = juce::jlimit(0.01f, 8.0f, rate);
         }
     };
 
-    std::vector<BiquadFilter> lpfFilters;
-    std::vector<BiquadFilter> hpfFilters;
+    const int allPassValues[16] = { 97, 109, 127, 139, 193, 251, 311, 373, 433, 491, 659, 619, 683, 757, 827, 887 };
+
+    std::vector<float> lineArena;
+    LineDelays delayLines;
+    LineAllPasses diffusionFilters;
+    LineModulatedAllPasses modulatedDiffusers;
+    LineAllPasses postDiffusers;
+    LineBiquads lpfFilters;
+    LineBiquads hpfFilters;
+
+    // Around the feedback path's static nonlinearities, see FDNSaturation.h
+    FDNSaturation::LineOversampler limiterOversampler, saturationOversampler;
+    std::atomic<int> oversamplingFactor{ 1 };
+
+    // Cutoffs the filter targets were last computed for (< 0 before the first block),
+    // coefficients are only recomputed when these move
+    double currentHpCutoff = -1.0;
+    double currentLpCutoff = -1.0;
+
+    // Cutoff changes ramp in steps of coefficientSubBlock samples over ~20ms
+    static constexpr int coefficientSubBlock = 16;
+    static constexpr double coefficientRampSeconds = 0.02;
+    int coefficientRampSubBlocks = 1;
+    LineDCBlockers dcBlockers;
+
+    // Lays out every line's delay and all-pass buffers in lineArena and clears them
+    void allocateLines(double sampleRateRatio);
 
     double sampleRate = 44100.0;
 
+    // Scratch memory, sized once in prepare()
+    std::vector<float> monoInput;
+    std::vector<float> earlyOutput;
+    alignas(16) LineArray feedbackSignals{};
+
     // Early Reflections
     struct EarlyReflection {
         int delaySamples;
         float gain;
     };
 
+    // Delays at 44.1kHz, scaled into earlyReflections by prepare()
+    static constexpr int numEarlyReflections = 16;
+    const EarlyReflection baseEarlyReflections[numEarlyReflections] = {
+        { 450,  0.65f }, { 850,  0.57f }, { 1250, 0.49f }, { 1800, 0.40f },
+        { 2500, 0.32f }, { 3200, 0.24f }, { 4000, 0.18f }, { 4800, 0.15f },
+        { 5400, 0.12f }, { 6000, 0.10f }, { 6500, 0.08f }, { 7000, 0.07f },
+        { 7500, 0.06f }, { 8000, 0.05f }, { 8500, 0.04f }, { 9000, 0.03f }
+    };
+
     std::vector<EarlyReflection> earlyReflections;
 
     std::vector<float> erBuffer;
@@ -338,69 +478,32 @@ private:
     int erWriteIndex = 0;
 
     AllPassFilter erDiffusion1;
-    AllPassFilter erDiffusion2;
-
-    // Soft Limiter
-    float softLimit(float input) {
-        const float threshold = 0.4f;
-        const float limit = 1.0f;   
-        const float curve = 1.5f;  
 
-        float abs_x = std::abs(input);
-        float sign = input > 0.0f ? 1.0f : -1.0f;
-
-        if (abs_x <= threshold) {
-            return input;
-        }
-        else if (abs_x <= limit) {
-            // Cubic soft knee
-            float t = (abs_x - threshold) / (limit - threshold);
-            float eased = threshold + (limit - threshold) * (t - t * t * t / 3.0f);
-            return sign * eased;
-        }
-        else {
-            float overshoot = abs_x - limit;
-            return sign * (limit - (1.0f / (overshoot + 1.0f)));
-        }
+    // Denormal Prevention
+    // Real denormals are flushed by FTZ/DAZ (ScopedNoDenormals in processBlock),
+    // this only deals with the near-silent tail: values under minLevel are either
+    // zeroed or, with tail dither on, replaced by tiny noise from a per-instance
+    // xorshift generator (deterministic and realtime-safe, unlike rand())
+    std::atomic<bool> tailDitherEnabled{ false };
+    bool tailDither = false; // The setting for the block being processed
+    juce::uint32 ditherState = ditherSeed;
+    static constexpr juce::uint32 ditherSeed = 0x9E3779B9u;
+
+    inline float nextDither() noexcept {
+        ditherState ^= ditherState << 13;
+        ditherState ^= ditherState >> 17;
+        ditherState ^= ditherState << 5;
+
+        // Uniform in [-1, 1)
+        return static_cast<float>(ditherState) * (2.0f / 4294967296.0f) - 1.0f;
     }
 
-    // Avoid DC Bias
-    struct DCBlocker {
-        float x1 = 0.0f, x2 = 0.0f;
-        float y1 = 0.0f, y2 = 0.0f;
-
-        void reset() {
-            x1 = x2 = 0.0f;
-            y1 = y2 = 0.0f;
-        }
-
-        float process(float input) {
-            // Second-order DC blocking filter (pole at 0.995, zero at 1.0)
-            const float R = 0.995f;
-            float x0 = input;
-
-            // Calculate output: y[n] = x[n] - x[n-2] + R^2 * y[n-2]
-            float output = x0 - x2 + R * R * y2;
-
-            // Update variables
-            x2 = x1;
-            x1 = x0;
-            y2 = y1;
-            y1 = output;
-
-            return output;
-        }
-    };
-
-    std::vector<DCBlocker> dcBlockers;
-
-    // Denormal Prevention
-    inline float denormalPrevention(float sample) {
+    inline float denormalPrevention(float sample) noexcept {
         static const float minLevel = 1.0e-8f;
         static const float antiDenormal = 1.0e-8f;
 
         if (std::abs(sample) < minLevel)
-            return antiDenormal * (2.0f * static_cast<float>(rand()) / RAND_MAX - 1.0f);
+            return tailDither ? antiDenormal * nextDither() : 0.0f;
         return sample;
     }
 
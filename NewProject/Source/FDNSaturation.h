@@ -0,0 +1,317 @@
+/*
+  ==============================================================================
+
+    FDNSaturation.h
+    Created: 27 Oct 2026 2:16:05pm
+    Author:  mikey
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include <array>
+
+#if JUCE_USE_SSE_INTRINSICS
+ #include <xmmintrin.h>
+#elif JUCE_USE_ARM_NEON
+ #include <arm_neon.h>
+#endif
+
+// The FDN's saturating curves, and an oversampler to run them at 2x or 4x so
+// their harmonics don't alias back into the feedback loop:
+//  - softLimit(): linear to 0.4, a cubic knee to 1, then 1/x
+//  - tanh():      juce's [7/6] Padé approximant, clamped to where it reaches 1
+//                 (within 1e-4 of std::tanh everywhere)
+// The versions taking all 16 lines work four at a time in SIMD registers, with
+// the branches of the scalar versions turned into selects.
+namespace FDNSaturation
+{
+    static constexpr int numLines = 16;
+    using LineArray = std::array<float, numLines>;
+
+    //==============================================================================
+    // Just the operations the curves and filters below need, on 4 lanes (or 1)
+    namespace Simd
+    {
+       #if JUCE_USE_SSE_INTRINSICS
+        using Vector = __m128;
+        using Mask = __m128;
+        static constexpr int width = 4;
+
+        inline Vector load(const float* p) noexcept              { return _mm_loadu_ps(p); }
+        inline void store(float* p, Vector v) noexcept           { _mm_storeu_ps(p, v); }
+        inline Vector broadcast(float v) noexcept                { return _mm_set1_ps(v); }
+        inline Vector add(Vector a, Vector b) noexcept           { return _mm_add_ps(a, b); }
+        inline Vector sub(Vector a, Vector b) noexcept           { return _mm_sub_ps(a, b); }
+        inline Vector mul(Vector a, Vector b) noexcept           { return _mm_mul_ps(a, b); }
+        inline Vector div(Vector a, Vector b) noexcept           { return _mm_div_ps(a, b); }
+        inline Vector min(Vector a, Vector b) noexcept           { return _mm_min_ps(a, b); }
+        inline Vector max(Vector a, Vector b) noexcept           { return _mm_max_ps(a, b); }
+        inline Vector abs(Vector a) noexcept                     { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+        inline Mask lessOrEqual(Vector a, Vector b) noexcept     { return _mm_cmple_ps(a, b); }
+        inline Vector select(Mask m, Vector a, Vector b) noexcept { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+
+        inline Vector copySign(Vector magnitude, Vector sign) noexcept
+        {
+            const __m128 signBit = _mm_set1_ps(-0.0f);
+            return _mm_or_ps(_mm_andnot_ps(signBit, magnitude), _mm_and_ps(signBit, sign));
+        }
+       #elif JUCE_USE_ARM_NEON
+        using Vector = float32x4_t;
+        using Mask = uint32x4_t;
+        static constexpr int width = 4;
+
+        inline Vector load(const float* p) noexcept              { return vld1q_f32(p); }
+        inline void store(float* p, Vector v) noexcept           { vst1q_f32(p, v); }
+        inline Vector broadcast(float v) noexcept                { return vdupq_n_f32(v); }
+        inline Vector add(Vector a, Vector b) noexcept           { return vaddq_f32(a, b); }
+        inline Vector sub(Vector a, Vector b) noexcept           { return vsubq_f32(a, b); }
+        inline Vector mul(Vector a, Vector b) noexcept           { return vmulq_f32(a, b); }
+        inline Vector min(Vector a, Vector b) noexcept           { return vminq_f32(a, b); }
+        inline Vector max(Vector a, Vector b) noexcept           { return vmaxq_f32(a, b); }
+        inline Vector abs(Vector a) noexcept                     { return vabsq_f32(a); }
+        inline Mask lessOrEqual(Vector a, Vector b) noexcept     { return vcleq_f32(a, b); }
+        inline Vector select(Mask m, Vector a, Vector b) noexcept { return vbslq_f32(m, a, b); }
+
+        inline Vector div(Vector a, Vector b) noexcept
+        {
+           #if JUCE_64BIT
+            return vdivq_f32(a, b);
+           #else
+            // No divide on 32-bit ARM: the reciprocal estimate and two Newton steps
+            float32x4_t reciprocal = vrecpeq_f32(b);
+            reciprocal = vmulq_f32(vrecpsq_f32(b, reciprocal), reciprocal);
+            reciprocal = vmulq_f32(vrecpsq_f32(b, reciprocal), reciprocal);
+            return vmulq_f32(a, reciprocal);
+           #endif
+        }
+
+        inline Vector copySign(Vector magnitude, Vector sign) noexcept
+        {
+            return vbslq_f32(vdupq_n_u32(0x80000000u), sign, magnitude);
+        }
+       #else
+        using Vector = float;
+        using Mask = bool;
+        static constexpr int width = 1;
+
+        inline Vector load(const float* p) noexcept              { return *p; }
+        inline void store(float* p, Vector v) noexcept           { *p = v; }
+        inline Vector broadcast(float v) noexcept                { return v; }
+        inline Vector add(Vector a, Vector b) noexcept           { return a + b; }
+        inline Vector sub(Vector a, Vector b) noexcept           { return a - b; }
+        inline Vector mul(Vector a, Vector b) noexcept           { return a * b; }
+        inline Vector div(Vector a, Vector b) noexcept           { return a / b; }
+        inline Vector min(Vector a, Vector b) noexcept           { return juce::jmin(a, b); }
+        inline Vector max(Vector a, Vector b) noexcept           { return juce::jmax(a, b); }
+        inline Vector abs(Vector a) noexcept                     { return std::abs(a); }
+        inline Mask lessOrEqual(Vector a, Vector b) noexcept     { return a <= b; }
+        inline Vector select(Mask m, Vector a, Vector b) noexcept { return m ? a : b; }
+        inline Vector copySign(Vector magnitude, Vector sign) noexcept { return std::copysign(magnitude, sign); }
+       #endif
+
+        inline Vector tanh(Vector x) noexcept
+        {
+            x = min(max(x, broadcast(-4.97f)), broadcast(4.97f));
+            const Vector x2 = mul(x, x);
+
+            const Vector numerator = mul(x, add(broadcast(135135.0f), mul(x2, add(broadcast(17325.0f), mul(x2, add(broadcast(378.0f), x2))))));
+            const Vector denominator = add(broadcast(135135.0f), mul(x2, add(broadcast(62370.0f), mul(x2, add(broadcast(3150.0f), mul(broadcast(28.0f), x2))))));
+            return div(numerator, denominator);
+        }
+
+        inline Vector softLimit(Vector input) noexcept
+        {
+            const Vector threshold = broadcast(0.4f), limit = broadcast(1.0f);
+            const Vector absX = abs(input);
+
+            // Cubic soft knee, (|x| - threshold) / (limit - threshold) clamped to [0, 1]
+            const Vector t = min(max(mul(sub(absX, threshold), broadcast(1.0f / 0.6f)), broadcast(0.0f)), broadcast(1.0f));
+            const Vector eased = add(threshold, mul(broadcast(0.6f), sub(t, div(mul(mul(t, t), t), broadcast(3.0f)))));
+
+            const Vector overshoot = sub(max(absX, limit), limit);
+            const Vector over = sub(limit, div(broadcast(1.0f), add(overshoot, broadcast(1.0f))));
+
+            const Vector shaped = select(lessOrEqual(absX, threshold), absX, select(lessOrEqual(absX, limit), eased, over));
+            return copySign(shaped, input);
+        }
+    }
+
+    //==============================================================================
+    inline float tanh(float x) noexcept
+    {
+        return juce::dsp::FastMathApproximations::tanh(juce::jlimit(-4.97f, 4.97f, x));
+    }
+
+    inline float softLimit(float input) noexcept
+    {
+        const float threshold = 0.4f;
+        const float limit = 1.0f;
+
+        float abs_x = std::abs(input);
+        float sign = input > 0.0f ? 1.0f : -1.0f;
+
+        if (abs_x <= threshold) {
+            return input;
+        }
+        else if (abs_x <= limit) {
+            // Cubic soft knee
+            float t = (abs_x - threshold) / (limit - threshold);
+            float eased = threshold + (limit - threshold) * (t - t * t * t / 3.0f);
+            return sign * eased;
+        }
+        else {
+            float overshoot = abs_x - limit;
+            return sign * (limit - (1.0f / (overshoot + 1.0f)));
+        }
+    }
+
+    // In place on all 16 lines
+    inline void softLimit(float* lines) noexcept
+    {
+        for (int i = 0; i < numLines; i += Simd::width)
+            Simd::store(lines + i, Simd::softLimit(Simd::load(lines + i)));
+    }
+
+    // In place on all 16 lines: tanh(x * drive) / drive
+    inline void tanh(float* lines, float drive) noexcept
+    {
+        const auto gain = Simd::broadcast(drive), makeUp = Simd::broadcast(1.0f / drive);
+
+        for (int i = 0; i < numLines; i += Simd::width)
+            Simd::store(lines + i, Simd::mul(Simd::tanh(Simd::mul(Simd::load(lines + i), gain)), makeUp));
+    }
+
+    //==============================================================================
+    // One 2x polyphase IIR half-band stage (two chains of first-order all-passes,
+    // the structure juce::dsp::Oversampling's IIR mode uses), for every line.
+    // Separate instances go up and down, each keeps its own state
+    template <int numCoefficients>
+    struct HalfBand
+    {
+        std::array<float, numCoefficients> coefficients;
+        alignas(16) std::array<LineArray, numCoefficients> x1{}, y1{};
+
+        explicit HalfBand(const std::array<float, numCoefficients>& c) : coefficients(c) {}
+
+        // One sample in, two out (the second is the later one)
+        void upsample(const float* in, float* first, float* second) noexcept {
+            std::copy_n(in, numLines, first);
+            std::copy_n(in, numLines, second);
+
+            for (int c = 0; c < numCoefficients; c += 2) {
+                allPass(c, first);
+                if (c + 1 < numCoefficients)
+                    allPass(c + 1, second);
+            }
+        }
+
+        // Two samples in (oldest first), one out
+        void downsample(const float* first, const float* second, float* out) noexcept {
+            alignas(16) LineArray a, b;
+            std::copy_n(second, numLines, a.data());
+            std::copy_n(first, numLines, b.data());
+
+            for (int c = 0; c < numCoefficients; c += 2) {
+                allPass(c, a.data());
+                if (c + 1 < numCoefficients)
+                    allPass(c + 1, b.data());
+            }
+
+            const auto half = Simd::broadcast(0.5f);
+            for (int i = 0; i < numLines; i += Simd::width)
+                Simd::store(out + i, Simd::mul(half, Simd::add(Simd::load(a.data() + i), Simd::load(b.data() + i))));
+        }
+
+        void reset() noexcept {
+            for (auto& line : x1) line.fill(0.0f);
+            for (auto& line : y1) line.fill(0.0f);
+        }
+
+    private:
+        void allPass(int c, float* x) noexcept {
+            const auto coefficient = Simd::broadcast(coefficients[static_cast<size_t>(c)]);
+            float* xs = x1[static_cast<size_t>(c)].data();
+            float* ys = y1[static_cast<size_t>(c)].data();
+
+            for (int i = 0; i < numLines; i += Simd::width) {
+                const auto in = Simd::load(x + i);
+                const auto out = Simd::add(Simd::mul(Simd::sub(in, Simd::load(ys + i)), coefficient), Simd::load(xs + i));
+                Simd::store(xs + i, in);
+                Simd::store(ys + i, out);
+                Simd::store(x + i, out);
+            }
+        }
+    };
+
+    //==============================================================================
+    // Runs a nonlinearity over all the lines at 1x, 2x or 4x, one sample at a
+    // time (it sits inside the feedback loop). The first stage rejects 80 dB from
+    // 0.475 of the base rate, the second only has to clear the first's images.
+    // The all-passes add a couple of samples of delay to the loop at low frequencies
+    class LineOversampler
+    {
+    public:
+        static constexpr int numOuterCoefficients = 6, numInnerCoefficients = 3;
+
+        // 1 (off), 2 or 4. Anything else is rounded down to one of those
+        void setFactor(int newFactor) noexcept {
+            factor = newFactor >= 4 ? 4 : (newFactor >= 2 ? 2 : 1);
+            reset();
+        }
+
+        int getFactor() const noexcept { return factor; }
+
+        void reset() noexcept {
+            outerUp.reset();
+            outerDown.reset();
+            innerUp.reset();
+            innerDown.reset();
+        }
+
+        // 'function' takes a pointer to numLines samples and shapes them in place
+        template <typename Function>
+        void process(float* lines, Function&& function) noexcept {
+            if (factor == 1) {
+                function(lines);
+                return;
+            }
+
+            alignas(16) LineArray first, second;
+            outerUp.upsample(lines, first.data(), second.data());
+
+            if (factor == 2) {
+                function(first.data());
+                function(second.data());
+            }
+            else {
+                alignas(16) std::array<LineArray, 4> quarter;
+                innerUp.upsample(first.data(), quarter[0].data(), quarter[1].data());
+                innerUp.upsample(second.data(), quarter[2].data(), quarter[3].data());
+
+                for (auto& sample : quarter)
+                    function(sample.data());
+
+                innerDown.downsample(quarter[0].data(), quarter[1].data(), first.data());
+                innerDown.downsample(quarter[2].data(), quarter[3].data(), second.data());
+            }
+
+            outerDown.downsample(first.data(), second.data(), lines);
+        }
+
+    private:
+        // Half-band designs: 6 coefficients with a 0.05 transition, and 3 with 0.25
+        static constexpr std::array<float, numOuterCoefficients> outerCoefficients{
+            0.060297390957f, 0.215971444561f, 0.412590720361f,
+            0.604358626466f, 0.772715653743f, 0.923886138653f
+        };
+        static constexpr std::array<float, numInnerCoefficients> innerCoefficients{
+            0.070224059253f, 0.285086280444f, 0.684541358924f
+        };
+
+        int factor = 1;
+        HalfBand<numOuterCoefficients> outerUp{ outerCoefficients }, outerDown{ outerCoefficients };
+        HalfBand<numInnerCoefficients> innerUp{ innerCoefficients }, innerDown{ innerCoefficients };
+    };
+}
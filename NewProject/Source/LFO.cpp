@@ -12,55 +12,97 @@
 
 LFO::LFO() : phase(0.0), sampleRate(44100.0)
 {
+    // Builds the table here rather than on the audio thread's first render
+    getSineTable();
 }
 
 LFO::~LFO()
 {
 }
 
-float LFO::processLFO(double lfoDepth, int lfoShape, int boxIndex)
+const std::array<float, LFO::sineTableSize + 1>& LFO::getSineTable() noexcept
+{
+    static const auto table = []
+    {
+        std::array<float, sineTableSize + 1> values;
+
+        for (int i = 0; i <= sineTableSize; ++i)
+            values[static_cast<size_t>(i)] = static_cast<float>(std::sin(juce::MathConstants<double>::twoPi * i / sineTableSize));
+
+        return values;
+    }();
+
+    return table;
+}
+
+void LFO::prepare(double newSampleRate, int maxBlockSize, int newControlInterval)
+{
+    sampleRate = newSampleRate;
+    controlInterval = juce::jlimit(ControlRate::minInterval, ControlRate::maxInterval, newControlInterval);
+    controlPoints.assign(static_cast<size_t>(ControlRate::getNumPoints(maxBlockSize, controlInterval)), 0.0f);
+    phase = 0.0;
+}
+
+const float* LFO::render(int numSamples, int lfoShape) noexcept
 {
     // Frequency to control LFO's oscillation
     auto frequency = 5.0;
 
-    // Depth scaling parameter dependant
-    const std::array<float, 3> depthScales = { 1.0f, 5.0f, 100.0f };
-    float depthScale = depthScales[std::clamp(boxIndex, 0, 2)];
-    const float depth = static_cast<float>(lfoDepth) * depthScale;
+    // prepare() must have been called with a big enough block size
+    const int numPoints = ControlRate::getNumPoints(numSamples, controlInterval);
+    jassert(numPoints <= static_cast<int>(controlPoints.size()));
+
+    const double increment = frequency / sampleRate;
+    const double pointIncrement = increment * controlInterval;
+    double pointPhase = phase;
 
-    // Phase update
-    phase += frequency / sampleRate;
-    if (phase >= 1.0)
-        phase -= 1.0;
+    for (int i = 0; i < juce::jmin(numPoints, static_cast<int>(controlPoints.size())); ++i)
+    {
+        controlPoints[static_cast<size_t>(i)] = getValue(pointPhase, lfoShape);
+
+        pointPhase += pointIncrement;
+        pointPhase -= std::floor(pointPhase);
+    }
+
+    // Phase update, by the block's real length
+    phase += increment * numSamples;
+    phase -= std::floor(phase);
+
+    return controlPoints.data();
+}
 
+float LFO::getValue(double phaseToRead, int lfoShape) const noexcept
+{
     float lfoValue = 0.0f;
 
     switch (lfoShape)
     {
     case 0: // Sine
-        lfoValue = std::sin(static_cast<float>(phase) * juce::MathConstants<float>::twoPi);
+    {
+        const auto& table = getSineTable();
+        const double position = phaseToRead * sineTableSize;
+        const int index = juce::jlimit(0, sineTableSize - 1, static_cast<int>(position));
+        const float fraction = static_cast<float>(position - index);
+        lfoValue = table[static_cast<size_t>(index)] + fraction * (table[static_cast<size_t>(index + 1)] - table[static_cast<size_t>(index)]);
         break;
+    }
 
     case 1: // Triangle
-        if (phase < 0.25)
-            lfoValue = static_cast<float>(4.0 * phase);
-        else if (phase < 0.75)
-            lfoValue = static_cast<float>(2.0 - 4.0 * phase);
+        if (phaseToRead < 0.25)
+            lfoValue = static_cast<float>(4.0 * phaseToRead);
+        else if (phaseToRead < 0.75)
+            lfoValue = static_cast<float>(2.0 - 4.0 * phaseToRead);
         else
-            lfoValue = static_cast<float>(4.0 * phase - 4.0);
-        lfoValue = lfoValue * 2.0f - 1.0f;
+            lfoValue = static_cast<float>(4.0 * phaseToRead - 4.0);
         break;
 
     case 2: // Square
-        lfoValue = (phase < 0.5) ? -1.0f : 1.0f;
+        lfoValue = (phaseToRead < 0.5) ? -1.0f : 1.0f;
         break;
 
     default:
         break;
     }
 
-    // Output
-    float result = lfoValue * depth;
-
-    return result;
-}
\ No newline at end of file
+    return lfoValue;
+}
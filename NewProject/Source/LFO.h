@@ -11,6 +11,7 @@
 #pragma once
 #include <JuceHeader.h>
 #include <algorithm>
+#include "ControlRate.h"
 
 class LFO
 {
@@ -18,10 +19,27 @@ public:
     LFO();
     ~LFO();
 
-    float processLFO(double lfoDepth, int lfoShape, int boxIndex);
-    void setSampleRate(double newSampleRate) { sampleRate = newSampleRate; }
+    // Sizes the control buffer for blocks of up to maxBlockSize, and restarts the phase
+    void prepare(double newSampleRate, int maxBlockSize, int newControlInterval = ControlRate::defaultInterval);
+
+    // Renders a block of numSamples at control rate, -1..1 (depth is up to the
+    // ModulationMatrix slot), and advances the phase by exactly numSamples,
+    // whatever the block size. Returns
+    // ControlRate::getNumPoints(numSamples, getControlInterval()) points, valid
+    // until the next call
+    const float* render(int numSamples, int lfoShape) noexcept;
+
+    int getControlInterval() const noexcept { return controlInterval; }
 
 private:
-    float phase = 0.0f;
+    // One cycle of a sine, linearly interpolated (guard point at the end)
+    static constexpr int sineTableSize = 512;
+    static const std::array<float, sineTableSize + 1>& getSineTable() noexcept;
+
+    float getValue(double phaseToRead, int lfoShape) const noexcept;
+
+    double phase = 0.0;
     double sampleRate = 44100.0;
-};
\ No newline at end of file
+    int controlInterval = ControlRate::defaultInterval;
+    std::vector<float> controlPoints;
+};
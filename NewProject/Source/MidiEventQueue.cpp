@@ -0,0 +1,80 @@
+/*
+  ==============================================================================
+
+    MidiEventQueue.cpp
+    Created: 22 Oct 2026 9:47:03am
+    Author:  mikey
+
+  ==============================================================================
+*/
+
+#include "MidiEventQueue.h"
+
+MidiEventQueue::MidiEventQueue()
+{
+    for (auto& word : pendingNoteOffs)
+        word.store(0, std::memory_order_relaxed);
+}
+
+bool MidiEventQueue::push(const juce::MidiMessage& message, double timeMs) noexcept
+{
+    const int size = message.getRawDataSize();
+
+    if (size < 1 || size > 3)
+    {
+        numOverflows.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    Event event{};
+    std::copy_n(message.getRawData(), size, event.data);
+    event.size = static_cast<juce::uint8>(size);
+    event.timeMs = timeMs;
+
+    // Older note-offs that didn't fit go first, so nothing overtakes them. If
+    // they still don't fit, neither would this
+    takePendingNoteOffs([this, timeMs](int channel, int note) { return tryPush(makeNoteOff(channel, note, timeMs)); });
+
+    if (!hasPendingNoteOffs.load(std::memory_order_acquire) && tryPush(event))
+        return true;
+
+    if (message.isNoteOff())
+    {
+        addPendingNoteOff(message.getChannel(), message.getNoteNumber());
+        return true;
+    }
+
+    numOverflows.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+bool MidiEventQueue::tryPush(const Event& event) noexcept
+{
+    const auto write = writeIndex.load(std::memory_order_relaxed);
+
+    if (write - readIndex.load(std::memory_order_acquire) >= static_cast<juce::uint32>(capacity))
+        return false;
+
+    events[static_cast<size_t>(write & mask)] = event;
+    writeIndex.store(write + 1, std::memory_order_release);
+    return true;
+}
+
+void MidiEventQueue::addPendingNoteOff(int channel, int note) noexcept
+{
+    const int index = (juce::jlimit(1, 16, channel) - 1) * 128 + (note & 127);
+
+    pendingNoteOffs[static_cast<size_t>(index / 64)].fetch_or(juce::uint64(1) << (index % 64), std::memory_order_acq_rel);
+    hasPendingNoteOffs.store(true, std::memory_order_release);
+}
+
+MidiEventQueue::Event MidiEventQueue::makeNoteOff(int channel, int note, double timeMs) noexcept
+{
+    Event event{};
+    event.data[0] = static_cast<juce::uint8>(0x80 | ((channel - 1) & 0x0f));
+    event.data[1] = static_cast<juce::uint8>(note & 0x7f);
+    event.data[2] = 0;
+    event.size = 3;
+    event.timeMs = timeMs;
+    return event;
+}
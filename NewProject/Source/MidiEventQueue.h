@@ -0,0 +1,123 @@
+/*
+  ==============================================================================
+
+    MidiEventQueue.h
+    Created: 22 Oct 2026 9:47:03am
+    Author:  mikey
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+// Short MIDI messages from the editor's keyboard to the audio thread.
+// A fixed ring of plain structs, so neither side ever allocates, locks or waits:
+// one writer thread (the message thread) and one reader (the audio thread).
+//
+// When the ring is full, note-offs aren't dropped. They go into a bitmap of
+// channel and note, and are delivered after everything that was queued before
+// them, so a flood of clicks can't leave a note stuck. Anything else that
+// doesn't fit is dropped and counted.
+class MidiEventQueue
+{
+public:
+    MidiEventQueue();
+
+    struct Event
+    {
+        juce::uint8 data[3];
+        juce::uint8 size;
+        double timeMs; // getMillisecondCounterHiRes() when it was played
+    };
+
+    // Writer thread. Messages longer than 3 bytes are refused (and counted)
+    bool push(const juce::MidiMessage& message, double timeMs) noexcept;
+
+    // Reader thread. Hands every queued event to callback in order, then any
+    // note-offs that found the ring full (timed as the last event) once
+    // nothing else is queued
+    template <typename Callback>
+    void popAll(Callback&& callback) noexcept
+    {
+        const auto end = writeIndex.load(std::memory_order_acquire);
+        auto read = readIndex.load(std::memory_order_relaxed);
+        double lastTimeMs = 0.0;
+
+        for (; read != end; ++read)
+        {
+            const auto& event = events[static_cast<size_t>(read & mask)];
+            lastTimeMs = event.timeMs;
+            callback(event);
+        }
+
+        readIndex.store(read, std::memory_order_release);
+
+        // The space just freed lets the writer queue more, and a note-on among
+        // it would be overtaken by a note-off taken now. Those wait a block
+        if (writeIndex.load(std::memory_order_acquire) != read)
+            return;
+
+        takePendingNoteOffs([&](int channel, int note)
+        {
+            callback(makeNoteOff(channel, note, lastTimeMs));
+            return true;
+        });
+    }
+
+    // Events dropped because the ring was full or they weren't short messages
+    int getNumOverflows() const noexcept { return numOverflows.load(std::memory_order_relaxed); }
+
+    static constexpr int capacity = 1024;
+
+private:
+    static constexpr juce::uint32 mask = capacity - 1;
+    static_assert((capacity & (capacity - 1)) == 0, "capacity must be a power of two");
+    static_assert(std::is_trivially_copyable<Event>::value, "Events are copied as plain bytes");
+
+    bool tryPush(const Event& event) noexcept;
+    void addPendingNoteOff(int channel, int note) noexcept;
+
+    // Either side: takes every pending note-off bit and hands it to handler,
+    // which returns false to put it (and the rest) back
+    template <typename Handler>
+    void takePendingNoteOffs(Handler&& handler) noexcept
+    {
+        if (!hasPendingNoteOffs.exchange(false, std::memory_order_acq_rel))
+            return;
+
+        for (size_t word = 0; word < pendingNoteOffs.size(); ++word)
+        {
+            auto bits = pendingNoteOffs[word].exchange(0, std::memory_order_acq_rel);
+
+            while (bits != 0)
+            {
+                const int bit = juce::countNumberOfBits(static_cast<juce::uint64>((bits & (~bits + 1)) - 1));
+                const int index = static_cast<int>(word) * 64 + bit;
+
+                if (!handler(index / 128 + 1, index % 128))
+                {
+                    // Later words are still set, the flag covers them too
+                    pendingNoteOffs[word].fetch_or(bits, std::memory_order_acq_rel);
+                    hasPendingNoteOffs.store(true, std::memory_order_release);
+                    return;
+                }
+
+                bits &= bits - 1;
+            }
+        }
+    }
+
+    static Event makeNoteOff(int channel, int note, double timeMs) noexcept;
+
+    std::array<Event, capacity> events;
+    std::atomic<juce::uint32> readIndex{ 0 }, writeIndex{ 0 };
+
+    // One bit per channel and note
+    std::array<std::atomic<juce::uint64>, 16 * 128 / 64> pendingNoteOffs;
+    std::atomic<bool> hasPendingNoteOffs{ false };
+
+    std::atomic<int> numOverflows{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiEventQueue)
+};
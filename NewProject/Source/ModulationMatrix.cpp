@@ -0,0 +1,242 @@
+/*
+  ==============================================================================
+
+    ModulationMatrix.cpp
+    Created: 23 Oct 2026 3:31:40pm
+    Author:  mikey
+
+  ==============================================================================
+*/
+
+#include "ModulationMatrix.h"
+
+ModulationMatrix::ModulationMatrix()
+{
+    sources.fill(nullptr);
+
+    for (auto& slot : slots)
+        slot.store(pack({}), std::memory_order_relaxed);
+}
+
+juce::uint64 ModulationMatrix::pack(const Slot& slot) noexcept
+{
+    // Depth's bits at the bottom, then destination + 1 (0 for none), then source
+    juce::uint32 depthBits;
+    std::memcpy(&depthBits, &slot.depth, sizeof(depthBits));
+    const auto destination = static_cast<juce::uint64>(static_cast<juce::uint16>(slot.destination + 1));
+
+    return static_cast<juce::uint64>(depthBits) | (destination << 32) | (static_cast<juce::uint64>(slot.source) << 48);
+}
+
+ModulationMatrix::Slot ModulationMatrix::unpack(juce::uint64 word) noexcept
+{
+    Slot slot;
+    const auto depthBits = static_cast<juce::uint32>(word);
+    std::memcpy(&slot.depth, &depthBits, sizeof(depthBits));
+    slot.destination = static_cast<int>((word >> 32) & 0xffff) - 1;
+    slot.source = static_cast<Source>(juce::jlimit(0, numSources - 1, static_cast<int>((word >> 48) & 0xff)));
+    return slot;
+}
+
+int ModulationMatrix::addDestination(const juce::String& parameterID, juce::NormalisableRange<float> range, const float* value)
+{
+    jassert(value != nullptr && findDestination(parameterID) < 0);
+    jassert(getNumDestinations() < 0xffff); // A slot packs destination + 1 into 16 bits
+
+    destinations.push_back({ parameterID, range, value });
+    return getNumDestinations() - 1;
+}
+
+int ModulationMatrix::findDestination(const juce::String& parameterID) const
+{
+    for (size_t i = 0; i < destinations.size(); ++i)
+        if (destinations[i].parameterID == parameterID)
+            return static_cast<int>(i);
+
+    return -1;
+}
+
+void ModulationMatrix::prepare(int maxBlockSize, int controlInterval)
+{
+    pointsPerRow = ControlRate::getNumPoints(maxBlockSize, juce::jmax(1, controlInterval));
+    numPointsProcessed = 0;
+
+    const auto size = static_cast<size_t>(pointsPerRow) * destinations.size();
+    normalised.assign(size, 0.0f);
+    values.assign(size, 0.0f);
+    modulated.assign(destinations.size(), 0);
+}
+
+void ModulationMatrix::setSlot(int slot, Source source, int destination, float depth) noexcept
+{
+    if (!juce::isPositiveAndBelow(slot, maxSlots))
+        return;
+
+    Slot s;
+    s.source = source;
+    s.destination = juce::isPositiveAndBelow(destination, getNumDestinations()) ? destination : -1;
+    s.depth = depth;
+
+    slots[static_cast<size_t>(slot)].store(pack(s), std::memory_order_relaxed);
+}
+
+void ModulationMatrix::process(int numPoints) noexcept
+{
+    // prepare() must have been called with a big enough block size
+    jassert(numPoints <= pointsPerRow);
+    numPoints = juce::jmin(numPoints, pointsPerRow);
+
+    std::fill(modulated.begin(), modulated.end(), 0);
+
+    for (auto& word : slots)
+    {
+        const auto slot = unpack(word.load(std::memory_order_relaxed));
+        const int destination = slot.destination;
+        const float depth = slot.depth;
+        const float* source = sources[static_cast<size_t>(slot.source)];
+
+        if (destination < 0 || depth == 0.0f || source == nullptr)
+            continue;
+
+        float* row = normalised.data() + static_cast<size_t>(destination) * static_cast<size_t>(pointsPerRow);
+
+        // First slot on this destination starts from the parameter itself
+        if (!modulated[static_cast<size_t>(destination)])
+        {
+            auto& d = destinations[static_cast<size_t>(destination)];
+            std::fill_n(row, numPoints, d.range.convertTo0to1(*d.value));
+            modulated[static_cast<size_t>(destination)] = 1;
+        }
+
+        for (int i = 0; i < numPoints; ++i)
+            row[i] += source[i] * depth;
+    }
+
+    for (size_t d = 0; d < destinations.size(); ++d)
+    {
+        auto& destination = destinations[d];
+        float* row = values.data() + d * static_cast<size_t>(pointsPerRow);
+
+        if (!modulated[d])
+        {
+            std::fill_n(row, numPoints, *destination.value);
+            continue;
+        }
+
+        const float* summed = normalised.data() + d * static_cast<size_t>(pointsPerRow);
+
+        for (int i = 0; i < numPoints; ++i)
+            row[i] = destination.range.convertFrom0to1(juce::jlimit(0.0f, 1.0f, summed[i]));
+    }
+
+    numPointsProcessed = numPoints;
+}
+
+const float* ModulationMatrix::getPoints(int destination) const noexcept
+{
+    jassert(juce::isPositiveAndBelow(destination, getNumDestinations()));
+    return values.data() + static_cast<size_t>(destination) * static_cast<size_t>(pointsPerRow);
+}
+
+float ModulationMatrix::getValue(int destination) const noexcept
+{
+    if (numPointsProcessed == 0)
+        return *destinations[static_cast<size_t>(destination)].value;
+
+    return getPoints(destination)[numPointsProcessed - 1];
+}
+
+//==============================================================================
+void MidiModulationSources::prepare(double newSampleRate, int maxBlockSize, int newControlInterval)
+{
+    sampleRate = newSampleRate;
+    controlInterval = juce::jmax(1, newControlInterval);
+
+    const auto numPoints = static_cast<size_t>(ControlRate::getNumPoints(maxBlockSize, controlInterval));
+    velocityPoints.assign(numPoints, 0.0f);
+    envelopePoints.assign(numPoints, 0.0f);
+    modWheelPoints.assign(numPoints, 0.0f);
+
+    envelopeLevel = 0.0f;
+    envelopeSample = 0;
+    heldNotes.fill(false);
+    numHeldNotes = 0;
+}
+
+void MidiModulationSources::render(const juce::MidiBuffer& midi, int numSamples) noexcept
+{
+    const int numPoints = juce::jmin(ControlRate::getNumPoints(numSamples, controlInterval), static_cast<int>(velocityPoints.size()));
+    int point = 0;
+
+    for (const auto metadata : midi)
+    {
+        // Points before the event see the state before it
+        while (point < numPoints && point * controlInterval < metadata.samplePosition)
+            writePoint(point++);
+
+        if (metadata.numBytes < 3)
+            continue;
+
+        const int status = metadata.data[0] & 0xf0;
+        const int channel = metadata.data[0] & 0x0f;
+        const int data1 = metadata.data[1] & 0x7f;
+        const int data2 = metadata.data[2] & 0x7f;
+        auto& held = heldNotes[static_cast<size_t>(channel * 128 + data1)];
+
+        if (status == 0x90 && data2 > 0)
+        {
+            moveEnvelopeTo(metadata.samplePosition);
+            envelopeLevel = 1.0f;
+            velocity = data2 / 127.0f;
+
+            if (!held)
+                ++numHeldNotes;
+            held = true;
+        }
+        else if (status == 0x80 || status == 0x90)
+        {
+            // The decay rate changes here, so the envelope is re-anchored first
+            moveEnvelopeTo(metadata.samplePosition);
+
+            if (held)
+                --numHeldNotes;
+            held = false;
+        }
+        else if (status == 0xb0 && data1 == 1)
+        {
+            modWheel = data2 / 127.0f;
+        }
+    }
+
+    while (point < numPoints)
+        writePoint(point++);
+
+    // The next block starts where this one ends
+    moveEnvelopeTo(numSamples);
+    envelopeSample = 0;
+}
+
+void MidiModulationSources::writePoint(int point) noexcept
+{
+    velocityPoints[static_cast<size_t>(point)] = velocity;
+    envelopePoints[static_cast<size_t>(point)] = getEnvelopeAt(point * controlInterval);
+    modWheelPoints[static_cast<size_t>(point)] = modWheel;
+}
+
+float MidiModulationSources::getEnvelopeAt(int sample) const noexcept
+{
+    if (envelopeLevel == 0.0f)
+        return 0.0f;
+
+    const double seconds = (numHeldNotes > 0 ? decaySeconds : releaseSeconds);
+    const float level = envelopeLevel * static_cast<float>(std::exp(-(sample - envelopeSample) / (seconds * sampleRate)));
+
+    // Nothing audible is left to modulate with, and it keeps the tail out of denormals
+    return level < 1.0e-4f ? 0.0f : level;
+}
+
+void MidiModulationSources::moveEnvelopeTo(int sample) noexcept
+{
+    envelopeLevel = getEnvelopeAt(sample);
+    envelopeSample = sample;
+}
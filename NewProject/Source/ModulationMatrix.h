@@ -0,0 +1,135 @@
+/*
+  ==============================================================================
+
+    ModulationMatrix.h
+    Created: 23 Oct 2026 3:31:40pm
+    Author:  mikey
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "ControlRate.h"
+
+// Routes modulation sources to parameters. Every source is a block of control
+// points (see ControlRate.h), every destination is a float parameter (read
+// from the block's ParameterSnapshot), and each slot adds source * depth to
+// one destination. Depth is a fraction of the destination's normalised range,
+// so 0.5 on a bipolar source sweeps half the range either way. Slots on the
+// same destination sum, then the result is clamped to the range.
+// process() is a pass per active slot over the block's points, so the cost
+// grows linearly with the number of slots in use, nothing else.
+class ModulationMatrix
+{
+public:
+    enum class Source
+    {
+        lfo1,       // -1..1
+        lfo2,       // -1..1
+        velocity,   // 0..1, last note-on
+        envelope,   // 0..1, see MidiModulationSources
+        modWheel    // 0..1, CC 1
+    };
+
+    static constexpr int numSources = 5;
+    static constexpr int maxSlots = 16;
+
+    ModulationMatrix();
+
+    // Message thread, before prepare(). value is the parameter's plain value,
+    // read at the start of every process(). Returns the destination's index
+    int addDestination(const juce::String& parameterID, juce::NormalisableRange<float> range, const float* value);
+    int findDestination(const juce::String& parameterID) const;
+    int getNumDestinations() const noexcept { return static_cast<int>(destinations.size()); }
+
+    void prepare(int maxBlockSize, int controlInterval);
+
+    // Any thread. A slot with no destination (-1) or no depth does nothing
+    void setSlot(int slot, Source source, int destination, float depth) noexcept;
+    void clearSlot(int slot) noexcept { setSlot(slot, Source::lfo1, -1, 0.0f); }
+
+    // Audio thread: this block's points for a source (nullptr leaves it silent)
+    void setSource(Source source, const float* points) noexcept { sources[static_cast<size_t>(source)] = points; }
+
+    // Audio thread: evaluates every destination at numPoints control points
+    void process(int numPoints) noexcept;
+
+    // Plain (unnormalised) values at the points of the last process()
+    const float* getPoints(int destination) const noexcept;
+
+    // Whether any slot moved the destination in the last process()
+    bool isModulated(int destination) const noexcept { return modulated[static_cast<size_t>(destination)] != 0; }
+
+    // Value at the last point of the last process(), i.e. at the start of the
+    // next block. The parameter itself before the first one
+    float getValue(int destination) const noexcept;
+
+private:
+    struct Destination
+    {
+        juce::String parameterID;
+        juce::NormalisableRange<float> range;
+        const float* value = nullptr;
+    };
+
+    // A slot's source, destination and depth in one word, so the audio thread
+    // always reads all three from the same setSlot()
+    struct Slot
+    {
+        Source source = Source::lfo1;
+        int destination = -1;
+        float depth = 0.0f;
+    };
+
+    static juce::uint64 pack(const Slot& slot) noexcept;
+    static Slot unpack(juce::uint64 word) noexcept;
+
+    std::vector<Destination> destinations;
+    std::array<std::atomic<juce::uint64>, maxSlots> slots;
+    std::array<const float*, numSources> sources{};
+
+    // One row of points per destination, normalised while summing, then plain
+    int pointsPerRow = 0;
+    int numPointsProcessed = 0;
+    std::vector<float> normalised, values;
+    std::vector<char> modulated;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ModulationMatrix)
+};
+
+// The MIDI driven sources, read from the block's merged MIDI at each control
+// point. Velocity and mod wheel hold their last value. The envelope jumps to 1
+// on every note-on and falls away exponentially: slowly while any key is held,
+// faster once they're all up, like the decay and damper of a struck string.
+class MidiModulationSources
+{
+public:
+    void prepare(double newSampleRate, int maxBlockSize, int newControlInterval);
+
+    void render(const juce::MidiBuffer& midi, int numSamples) noexcept;
+
+    const float* getVelocityPoints() const noexcept { return velocityPoints.data(); }
+    const float* getEnvelopePoints() const noexcept { return envelopePoints.data(); }
+    const float* getModWheelPoints() const noexcept { return modWheelPoints.data(); }
+
+    static constexpr double decaySeconds = 1.5;    // Time constant while keys are held
+    static constexpr double releaseSeconds = 0.25; // ... and once they're all up
+
+private:
+    void writePoint(int point) noexcept;
+    float getEnvelopeAt(int sample) const noexcept;
+    void moveEnvelopeTo(int sample) noexcept;
+
+    double sampleRate = 44100.0;
+    int controlInterval = ControlRate::defaultInterval;
+    std::vector<float> velocityPoints, envelopePoints, modWheelPoints;
+
+    float velocity = 0.0f, modWheel = 0.0f;
+
+    // Envelope level at envelopeSample (relative to the block's start)
+    float envelopeLevel = 0.0f;
+    int envelopeSample = 0;
+    std::array<bool, 16 * 128> heldNotes{};
+    int numHeldNotes = 0;
+};
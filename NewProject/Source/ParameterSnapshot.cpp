@@ -0,0 +1,71 @@
+/*
+  ==============================================================================
+
+    ParameterSnapshot.cpp
+    Created: 24 Oct 2026 9:12:26am
+    Author:  mikey
+
+  ==============================================================================
+*/
+
+#include "ParameterSnapshot.h"
+
+ParameterSnapshot::ParameterSnapshot(juce::AudioProcessorValueTreeState& apvts)
+{
+    const std::pair<const char*, float*> layout[] = {
+        { "GAIN", &values.gain },
+        { "PITCH_BEND", &values.pitchBend },
+        { "RESAMPLER_QUALITY", &values.resamplerQuality },
+        { "POLYPHONY", &values.polyphony },
+        { "ARPEGGIATOR", &values.arpeggiator },
+
+        { "PREDELAY", &values.predelay },
+        { "DECAY", &values.decay },
+        { "DRYWET", &values.dryWet },
+        { "DIFFUSION", &values.diffusion },
+        { "REVERB_ENABLED", &values.reverbEnabled },
+        { "REVERB_MODE", &values.reverbMode },
+        { "HIGH_CUTOFF", &values.highCutoff },
+        { "LOW_CUTOFF", &values.lowCutoff },
+
+        { "OSC1_DEPTH", &values.osc[0].depth },
+        { "OSC1_SHAPE", &values.osc[0].shape },
+        { "OSC1_TARGET", &values.osc[0].target },
+        { "OSC1_ENABLED", &values.osc[0].enabled },
+        { "OSC2_DEPTH", &values.osc[1].depth },
+        { "OSC2_SHAPE", &values.osc[1].shape },
+        { "OSC2_TARGET", &values.osc[1].target },
+        { "OSC2_ENABLED", &values.osc[1].enabled }
+    };
+
+    for (const auto& [parameterID, value] : layout)
+    {
+        auto* source = apvts.getRawParameterValue(parameterID);
+
+        // Every field needs a parameter in createParameters()
+        jassert(source != nullptr);
+
+        if (source != nullptr)
+        {
+            fields.push_back({ parameterID, source, value });
+            *value = source->load();
+        }
+    }
+}
+
+const ParameterValues& ParameterSnapshot::update() noexcept
+{
+    for (const auto& field : fields)
+        *field.value = field.source->load(std::memory_order_relaxed);
+
+    return values;
+}
+
+const float* ParameterSnapshot::find(const juce::String& parameterID) const noexcept
+{
+    for (const auto& field : fields)
+        if (field.parameterID == parameterID)
+            return field.value;
+
+    return nullptr;
+}
@@ -0,0 +1,75 @@
+/*
+  ==============================================================================
+
+    ParameterSnapshot.h
+    Created: 24 Oct 2026 9:12:26am
+    Author:  mikey
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+// Every parameter's value for one block, as plain data. Choices, ints and bools
+// are stored the way the APVTS holds them (as floats)
+struct ParameterValues
+{
+    float gain = 0.0f;
+    float pitchBend = 0.0f;
+    float resamplerQuality = 0.0f;
+    float polyphony = 0.0f;
+    float arpeggiator = 0.0f;
+
+    float predelay = 0.0f;
+    float decay = 0.0f;
+    float dryWet = 0.0f;
+    float diffusion = 0.0f;
+    float reverbEnabled = 0.0f;
+    float reverbMode = 0.0f;
+    float highCutoff = 0.0f;
+    float lowCutoff = 0.0f;
+
+    struct Oscillator
+    {
+        float depth = 0.0f;
+        float shape = 0.0f;
+        float target = 0.0f;
+        float enabled = 0.0f;
+    };
+
+    std::array<Oscillator, 2> osc;
+};
+
+// The APVTS's parameter atomics, looked up by ID once (in the constructor)
+// instead of by string every block. update() copies them all into a
+// ParameterValues, so the audio thread reads each parameter once per block and
+// everything in that block sees the same values.
+class ParameterSnapshot
+{
+public:
+    explicit ParameterSnapshot(juce::AudioProcessorValueTreeState& apvts);
+
+    // Audio thread, once at the start of each block
+    const ParameterValues& update() noexcept;
+
+    // The values from the last update()
+    const ParameterValues& get() const noexcept { return values; }
+
+    // Where a parameter lives in get(), or nullptr if it isn't in the snapshot.
+    // The address stays the same for the snapshot's lifetime
+    const float* find(const juce::String& parameterID) const noexcept;
+
+private:
+    struct Field
+    {
+        juce::String parameterID;
+        std::atomic<float>* source = nullptr;
+        float* value = nullptr;
+    };
+
+    ParameterValues values;
+    std::vector<Field> fields;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ParameterSnapshot)
+};
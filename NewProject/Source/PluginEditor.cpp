@@ -19,8 +19,15 @@ NewProjectAudioProcessorEditor::NewProjectAudioProcessorEditor (NewProjectAudioP
 	addAndMakeVisible(waveScreen);
     addAndMakeVisible(leftControls);
     addAndMakeVisible(reverbControls);
+
+    reverbControls.onLoadImpulseResponse = [this](const juce::File& file) { return audioProcessor.loadImpulseResponse(file); };
+    reverbControls.onCaptureImpulseResponse = [this] { audioProcessor.useReverbAsImpulseResponse(); };
     addAndMakeVisible(oscillatorControls);
 
+    loadingBar.setTextToDisplay("Loading samples");
+    addChildComponent(loadingBar);
+    loadingBar.setVisible(!audioProcessor.areSamplesLoaded());
+
     // C0 to F6
     keyboardComponent.setAvailableRange(24, 101);
     keyboardState.addListener(this);
@@ -70,6 +77,8 @@ void NewProjectAudioProcessorEditor::resized()
         oscillatorControls.getY(), // Same Y as oscillatorControls
         screenWidth,
         screenHeight);
+
+    loadingBar.setBounds(waveScreen.getBounds().withSizeKeepingCentre(screenWidth - 20, 20));
 }
 
 
@@ -113,6 +122,7 @@ void NewProjectAudioProcessorEditor::handleNoteOn(juce::MidiKeyboardState*, int
 {
     // Send a note-on message to the processor
     juce::MidiMessage message = juce::MidiMessage::noteOn(midiChannel, midiNoteNumber, velocity);
+    message.setTimeStamp(juce::Time::getMillisecondCounterHiRes());
     audioProcessor.addMidiMessage(message);
 }
 
@@ -120,32 +130,30 @@ void NewProjectAudioProcessorEditor::handleNoteOff(juce::MidiKeyboardState*, int
 {
     // Send a note-off message to the processor
     juce::MidiMessage message = juce::MidiMessage::noteOff(midiChannel, midiNoteNumber);
+    message.setTimeStamp(juce::Time::getMillisecondCounterHiRes());
     audioProcessor.addMidiMessage(message);
 }
 
 void NewProjectAudioProcessorEditor::timerCallback()
 {
-    if (waveScreen.getVisualiserStatus()) {
-        int availableSamples = audioProcessor.fifoIndex.load();
-        if (availableSamples >= audioProcessor.fifoSize)
-        {
-            availableSamples = audioProcessor.fifoSize;
-        }
+    if (loadingBar.isVisible())
+    {
+        loadingProgress = audioProcessor.getSampleLoadingProgress();
 
-        if (availableSamples > 0)
-        {
-            juce::AudioBuffer<float> tempBuffer(1, availableSamples);
+        if (audioProcessor.areSamplesLoaded())
+            loadingBar.setVisible(false);
+    }
 
-            for (int i = 0; i < availableSamples; ++i)
-            {
-                tempBuffer.setSample(0, i, audioProcessor.fifoBuffer.getSample(0, i));
-            }
+    if (waveScreen.getVisualiserStatus()) {
+        // Latest samples only, decimated and bounded by scopeBuffer's size
+        const int numSamples = audioProcessor.scopeFifo.pull(scopeBuffer.getWritePointer(0),
+            scopeBuffer.getNumSamples(), WaveScreen::scopeDecimation);
 
+        if (numSamples > 0)
+        {
             // Push samples into the visualiser
-            waveScreen.audioVisualiser.pushBuffer(tempBuffer);
-
-            // Reset FIFO index
-            audioProcessor.fifoIndex.store(0);
+            const float* channels[] = { scopeBuffer.getReadPointer(0) };
+            waveScreen.audioVisualiser.pushBuffer(channels, 1, numSamples);
         }
     }
 }
\ No newline at end of file
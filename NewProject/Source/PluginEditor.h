@@ -40,11 +40,16 @@ private:
     void handleNoteOff(juce::MidiKeyboardState*, int midiChannel, int midiNoteNumber, float velocity) override;
 
 	WaveScreen waveScreen;
+    juce::AudioBuffer<float> scopeBuffer{ 1, 1024 }; // Decimated samples pulled per timer tick
     juce::ToggleButton arpegiattorButton;
     juce::Slider pitchBendSlider;
     LeftControls leftControls;
     ReverbControls reverbControls;
     OscillatorControls oscillatorControls;
 
+    // Shown over the wave screen while the samples load
+    double loadingProgress = 0.0;
+    juce::ProgressBar loadingBar{ loadingProgress };
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (NewProjectAudioProcessorEditor)
 };
@@ -9,6 +9,7 @@
 #pragma once
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "AllocationGuard.h"
 
 //==============================================================================
 NewProjectAudioProcessor::NewProjectAudioProcessor()
@@ -24,19 +25,32 @@ NewProjectAudioProcessor::NewProjectAudioProcessor()
 	apvts(*this, nullptr, "Parameters", createParameters())
 #endif
 {
-	// Add voices to the synthesiser
-	for (int i = 0; i < 8; ++i)
-	{
-		synth.addVoice(new juce::SamplerVoice());
-	}
-
-	// Load samples
+	// Load samples (returns straight away, the shared pool fills in the background)
 	synth.loadSamples();
 
-	fifoBuffer.setSize(1, fifoSize);
-
-	// Make sure they're the same size
-	midiBuffer.resize(midiFifo.getTotalSize());
+	// Every float parameter can be modulated
+	for (auto* parameter : getParameters())
+		if (auto* floatParameter = dynamic_cast<juce::AudioParameterFloat*>(parameter))
+			modulationMatrix.addDestination(floatParameter->paramID, floatParameter->range,
+				parameters.find(floatParameter->paramID));
+
+	gainDestination = modulationMatrix.findDestination("GAIN");
+	pitchBendDestination = modulationMatrix.findDestination("PITCH_BEND");
+	dryWetDestination = modulationMatrix.findDestination("DRYWET");
+	highCutoffDestination = modulationMatrix.findDestination("HIGH_CUTOFF");
+	lowCutoffDestination = modulationMatrix.findDestination("LOW_CUTOFF");
+	predelayDestination = modulationMatrix.findDestination("PREDELAY");
+	decayDestination = modulationMatrix.findDestination("DECAY");
+	diffusionDestination = modulationMatrix.findDestination("DIFFUSION");
+	oscDepthDestinations = { modulationMatrix.findDestination("OSC1_DEPTH"), modulationMatrix.findDestination("OSC2_DEPTH") };
+	oscShapeDestinations = { modulationMatrix.findDestination("OSC1_SHAPE"), modulationMatrix.findDestination("OSC2_SHAPE") };
+
+	// In the order of the OSC1_TARGET/OSC2_TARGET choices
+	oscTargetDestinations = { diffusionDestination, decayDestination, predelayDestination };
+
+	// Room for a busy block of host MIDI plus a full keyboard queue, so the merge
+	// in processBlock doesn't have to grow it
+	liveMidi.ensureSize(16384 + MidiEventQueue::capacity * 16);
 }
 
 NewProjectAudioProcessor::~NewProjectAudioProcessor()
@@ -78,7 +92,20 @@ bool NewProjectAudioProcessor::isMidiEffect() const
 
 double NewProjectAudioProcessor::getTailLengthSeconds() const
 {
-	return 0.0;
+	// Straight from the parameters, the snapshot belongs to the audio thread
+	auto value = [this](const char* parameterID) { return static_cast<double>(apvts.getRawParameterValue(parameterID)->load()); };
+
+	if (value("REVERB_ENABLED") < 0.5)
+		return 0.0;
+
+	const double sampleRate = getSampleRate() > 0.0 ? getSampleRate() : 44100.0;
+	const double fdnTail = FDNReverb::getTailSeconds(sampleRate, value("PREDELAY"), value("DECAY"));
+
+	// A loaded impulse response can ring on longer than the FDN
+	if (value("REVERB_MODE") > 0.5)
+		return juce::jmax(fdnTail, convolutionReverb.getImpulseResponseSeconds());
+
+	return fdnTail;
 }
 
 int NewProjectAudioProcessor::getNumPrograms()
@@ -109,9 +136,31 @@ void NewProjectAudioProcessor::changeProgramName(int index, const juce::String&
 void NewProjectAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
 	synth.setCurrentPlaybackSampleRate(sampleRate);
-	lfo1.setSampleRate(sampleRate);
-	lfo2.setSampleRate(sampleRate);
-	fdnReverb.prepare(sampleRate);
+	previousBlockStartMs = 0.0;
+	lfo1.prepare(sampleRate, samplesPerBlock, controlInterval);
+	lfo2.prepare(sampleRate, samplesPerBlock, controlInterval);
+	midiModulation.prepare(sampleRate, samplesPerBlock, lfo1.getControlInterval());
+	modulationMatrix.prepare(samplesPerBlock, lfo1.getControlInterval());
+	fdnReverb.prepare(sampleRate, samplesPerBlock);
+	{
+		const juce::ScopedLock sl(impulseResponseLock);
+		convolutionReverb.prepare(sampleRate, getTotalNumOutputChannels());
+	}
+	reverbFreezer.prepare(sampleRate, getTotalNumOutputChannels());
+
+	reverbCrossfadeBuffer.setSize(juce::jmax(1, getTotalNumOutputChannels()), samplesPerBlock);
+	reverbCrossfadeLength = juce::jmax(1, static_cast<int>(reverbCrossfadeSeconds * sampleRate));
+	reverbCrossfadeRemaining = 0;
+	reverbHandoverRemaining = 0;
+
+	idleHoldSamples = juce::jmax(1, static_cast<int>(idleHoldSeconds * sampleRate));
+	quietSamples = 0;
+	idle = false;
+
+	// The MIDI sources keep their buffers until the next prepareToPlay
+	modulationMatrix.setSource(ModulationMatrix::Source::velocity, midiModulation.getVelocityPoints());
+	modulationMatrix.setSource(ModulationMatrix::Source::envelope, midiModulation.getEnvelopePoints());
+	modulationMatrix.setSource(ModulationMatrix::Source::modWheel, midiModulation.getModWheelPoints());
 }
 
 void NewProjectAudioProcessor::releaseResources()
@@ -120,6 +169,16 @@ void NewProjectAudioProcessor::releaseResources()
 	// spare memory, etc.
 }
 
+void NewProjectAudioProcessor::setNonRealtime(bool isNonRealtime) noexcept
+{
+	juce::AudioProcessor::setNonRealtime(isNonRealtime);
+
+	// Offline renders can wait on the disk stream, live playback can't
+	synth.getStreamer().setNonRealtime(isNonRealtime);
+	convolutionReverb.setNonRealtime(isNonRealtime);
+	reverbFreezer.setNonRealtime(isNonRealtime);
+}
+
 #ifndef JucePlugin_PreferredChannelConfigurations
 bool NewProjectAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
 {
@@ -148,6 +207,12 @@ bool NewProjectAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts
 
 void NewProjectAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
+	// Debug builds assert if anything below touches the heap
+	AllocationGuard::ScopedNoAllocation noAllocation;
+
+	// FTZ/DAZ for the whole callback, the reverb tail would otherwise decay into denormals
+	juce::ScopedNoDenormals noDenormals;
+
 	auto totalNumInputChannels = getTotalNumInputChannels();
 	auto totalNumOutputChannels = getTotalNumOutputChannels();
 
@@ -160,201 +225,352 @@ void NewProjectAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, ju
 		}
 	}
 
-	// Merge custom MIDI messages into the incoming MIDI buffer
-	int numToRead = midiFifo.getNumReady();
-	int start1, size1, start2, size2;
-	midiFifo.prepareToRead(numToRead, start1, size1, start2, size2);
+	// Every parameter, once, for the whole block
+	const auto& params = parameters.update();
+
+	// Host MIDI plus the editor's keyboard, in our own preallocated buffer
+	const int numSamples = buffer.getNumSamples();
+	const double blockStartMs = juce::Time::getMillisecondCounterHiRes();
+
+	liveMidi.clear();
+	liveMidi.addEvents(midiMessages, 0, numSamples, 0);
 
-	// First Block
-	if (size1 > 0)
+	keyboardQueue.popAll([this, numSamples](const MidiEventQueue::Event& event)
 	{
-		for (int i = 0; i < size1; ++i)
-			midiMessages.addEvent(midiBuffer[start1 + i], midiBuffer[start1 + i].getTimeStamp());
+		liveMidi.addEvent(event.data, event.size, getGuiEventOffset(event.timeMs, numSamples));
+	});
 
-		midiFifo.finishedRead(size1);
-	}
+	previousBlockStartMs = blockStartMs;
 
-	// Second Block
-	if (size2 > 0)
+	// Idle: the synth only needs to see the MIDI (pedal, note-offs), and the
+	// MIDI sources keep tracking it. No LFOs, gain or reverb until a note-on
+	if (idle.load(std::memory_order_relaxed))
 	{
-		for (int i = 0; i < size2; ++i)
-			midiMessages.addEvent(midiBuffer[start2 + i], midiBuffer[start2 + i].getTimeStamp());
+		if (!containsNoteOn(liveMidi))
+		{
+			midiModulation.render(liveMidi, numSamples);
+			synth.renderNextBlock(buffer, liveMidi, 0, numSamples);
+			midiMessages.clear();
+			return;
+		}
 
-		midiFifo.finishedRead(size2);
+		idle = false;
 	}
 
-	// Process audio
-	synth.renderNextBlock(buffer, midiMessages, 0, buffer.getNumSamples());
+	// Modulation for the whole block at control rate, before anything reads a parameter
+	const int interval = lfo1.getControlInterval();
+	const int numControlPoints = ControlRate::getNumPoints(numSamples, interval);
+	updateModulation(params, numSamples, numControlPoints);
 
-	// Write to FIFO buffer
-	const int numSamples = buffer.getNumSamples();
-	const float* writePointer = buffer.getReadPointer(0);
+	// Polyphony, pitch bend (semitones) and interpolation quality for the sampler voices
+	synth.setNumVoices(static_cast<int>(params.polyphony));
+	synth.setPitchBend(modulationMatrix.getPoints(pitchBendDestination)[0]);
+	synth.setResamplerQuality(static_cast<Resampler::Quality>(static_cast<int>(params.resamplerQuality)));
 
-	for (int i = 0; i < numSamples; ++i)
-	{
-		fifoBuffer.setSample(0, fifoIndex % fifoSize, writePointer[i]);
-		fifoIndex++;
-	}
+	// Process audio, timed for the synth's CPU budget
+	const auto synthStartTicks = juce::Time::getHighResolutionTicks();
+	synth.renderNextBlock(buffer, liveMidi, 0, numSamples);
+	const auto synthTicks = juce::Time::getHighResolutionTicks() - synthStartTicks;
 
 	// No MIDI output
 	midiMessages.clear();
 
 	// ================================================================
 
-	// Reverb parameters to modulate
-	double baseDecay = apvts.getRawParameterValue("DECAY")->load();
-	double baseDiffusion = apvts.getRawParameterValue("DIFFUSION")->load();
-	double basePredelay = apvts.getRawParameterValue("PREDELAY")->load();
-
-	// Process LFO modulation if enabled
-	double osc1Depth = apvts.getRawParameterValue("OSC1_DEPTH")->load();
-	int osc1Shape = static_cast<int>(apvts.getRawParameterValue("OSC1_SHAPE")->load());
-	int osc1Target = static_cast<int>(apvts.getRawParameterValue("OSC1_TARGET")->load());
-	bool osc1Enabled = apvts.getRawParameterValue("OSC1_ENABLED")->load() > 0.5f;
-
-	double osc2Depth = apvts.getRawParameterValue("OSC2_DEPTH")->load();
-	int osc2Shape = static_cast<int>(apvts.getRawParameterValue("OSC2_SHAPE")->load());
-	int osc2Target = static_cast<int>(apvts.getRawParameterValue("OSC2_TARGET")->load());
-	bool osc2Enabled = apvts.getRawParameterValue("OSC2_ENABLED")->load() > 0.5f;
-
-	// Modulate parameters with LFOs if enabled
-	double modulatedDiffusion = baseDiffusion;
-	double modulatedDecay = baseDecay;
-	double modulatedPredelay = basePredelay;
-
-	// In PluginProcessor.cpp, replace the switch statements with these fixed versions:
-
-	if (osc1Enabled) {
-		float modValue = lfo1.processLFO(osc1Depth, osc1Shape, osc1Target);
-
-		switch (osc1Target) {
-		case 0: // Diffusion (0.0 - 1.0 range)
-			modulatedDiffusion = juce::jlimit(0.0, 1.0,
-				baseDiffusion + (modValue * 0.5)); // 50% of diffusion range
-			break;
-		case 1: // Decay (0.8 - 5.0 range)
-			modulatedDecay = juce::jlimit(0.8, 5.0,
-				baseDecay + (modValue * 2.1)); // 50% of decay range
-			break;
-		case 2: // Predelay (0.0 - 100.0 range)
-			modulatedPredelay = juce::jlimit(0.0, 100.0,
-				basePredelay + (modValue * 50.0)); // 50% of predelay range
-			break;
-		}
-	}
+	// Gain Control, ramped between the control points
+	const float* gainPoints = modulationMatrix.getPoints(gainDestination);
+
+	for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+	{
+		auto* channelData = buffer.getWritePointer(channel);
+		ControlRate::Ramp gainRamp;
+
+		for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
+		{
+			if ((sample % interval) == 0)
+				gainRamp.start(gainPoints[sample / interval], gainPoints[sample / interval + 1], interval);
 
-	if (osc2Enabled) {
-		float modValue = lfo2.processLFO(osc2Depth, osc2Shape, osc2Target);
-
-		switch (osc2Target) {
-		case 0: // Diffusion (0.0 - 1.0 range)
-			modulatedDiffusion = juce::jlimit(0.0, 1.0,
-				baseDiffusion + (modValue * 0.5)); // 50% of diffusion range
-			break;
-		case 1: // Decay (0.8 - 5.0 range)
-			modulatedDecay = juce::jlimit(0.8, 5.0,
-				baseDecay + (modValue * 2.1)); // 50% of decay range
-			break;
-		case 2: // Predelay (0.0 - 100.0 range)
-			modulatedPredelay = juce::jlimit(0.0, 100.0,
-				basePredelay + (modValue * 50.0)); // 50% of predelay range
-			break;
+			channelData[sample] *= gainRamp.next();
 		}
 	}
 
+	// The reverb's input, for the idle check once it's done
+	bool inputQuiet = synth.getNumActiveVoices() == 0;
+	for (int channel = 0; channel < buffer.getNumChannels() && inputQuiet; ++channel)
+		inputQuiet = buffer.getMagnitude(channel, 0, numSamples) < idleThreshold;
 
-	// Gain Control
-	auto localGain = apvts.getRawParameterValue("GAIN")->load();
+	if (params.reverbEnabled > 0.5f)
+		processReverb(buffer, params, interval);
 
-	for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+	updateIdleState(inputQuiet, buffer);
+
+	// Feed the oscilloscope, only while it's switched on
+	if (WaveScreen::getVisualiserStatus() && buffer.getNumChannels() > 0)
 	{
-		auto* channelData = buffer.getWritePointer(channel);
-		for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-			channelData[sample] *= localGain;
+		// Scaled just for visualization purposes
+		const float visualizationGain = 2.0f;
+		scopeFifo.push(buffer.getReadPointer(0), numSamples, visualizationGain);
 	}
 
-	if (auto* reverbEnabled = apvts.getRawParameterValue("REVERB_ENABLED"))
+	// Voices taking too much of the deadline drops the quietest one. Only their
+	// own share counts, the reverb and scope cost the same whatever is playing.
+	// Offline renders have no deadline (and may wait on the sample streamer)
+	if (!isNonRealtime() && getSampleRate() > 0.0 && numSamples > 0)
 	{
-		if (reverbEnabled->load())
+		const double deadline = numSamples / getSampleRate();
+		synth.enforceCpuBudget(juce::Time::highResolutionTicksToSeconds(synthTicks) / deadline);
+	}
+}
+
+void NewProjectAudioProcessor::updateModulation(const ParameterValues& params, int numSamples, int numControlPoints) noexcept
+{
+	midiModulation.render(liveMidi, numSamples);
+
+	// The OSC panels feed slots 0 and 1, depth 1 sweeps half the target's range
+	// either way. Their own depth and shape are read from the previous block's
+	// evaluation, an LFO can't modulate itself within the block it renders
+	LFO* lfos[] = { &lfo1, &lfo2 };
+	const ModulationMatrix::Source lfoSources[] = { ModulationMatrix::Source::lfo1, ModulationMatrix::Source::lfo2 };
+
+	for (int osc = 0; osc < 2; ++osc)
+	{
+		const auto& oscParams = params.osc[static_cast<size_t>(osc)];
+
+		if (oscParams.enabled < 0.5f)
 		{
-			// Get all reverb parameters
-			auto dryWet = apvts.getRawParameterValue("DRYWET")->load();
-
-			// HPF and LPF
-			auto hpCutoff = apvts.getRawParameterValue("HIGH_CUTOFF")->load();
-			auto lpCutoff = apvts.getRawParameterValue("LOW_CUTOFF")->load();
-
-			// Save original dry signal if you need to mix it later
-			juce::AudioBuffer<float> dryBuffer;
-			if (dryWet < 1.0f) { // Only copy if we need to mix dry signal
-				dryBuffer.makeCopyOf(buffer);
-			}
-
-			// Process audio with reverb
-			auto outputs = fdnReverb.process(buffer, modulatedPredelay, modulatedDecay, modulatedDiffusion, hpCutoff, lpCutoff);
-
-			// Clear the buffer as we'll fill it with the processed signal
-			buffer.clear();
-
-			// Mix the output of all delay lines back into the buffer
-			for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
-			{
-				for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-				{
-					float mixedSample = 0.0f;
-
-					for (int i = 0; i < outputs.size(); ++i)
-						mixedSample += outputs[i][sample];
-
-					mixedSample /= outputs.size();
-
-					if (dryWet < 1.0f)
-					{
-						float drySample = dryBuffer.getSample(channel, sample);
-						mixedSample = drySample * (1.0f - dryWet) + mixedSample * dryWet;
-					}
-
-					buffer.setSample(channel, sample, mixedSample);
-				}
-			}
+			modulationMatrix.setSource(lfoSources[osc], nullptr);
+			modulationMatrix.clearSlot(osc);
+			continue;
 		}
+
+		const int shape = static_cast<int>(modulationMatrix.getValue(oscShapeDestinations[osc]));
+		const float depth = modulationMatrix.getValue(oscDepthDestinations[osc]) * 0.5f;
+		const int target = oscTargetDestinations[static_cast<size_t>(juce::jlimit(0, 2, static_cast<int>(oscParams.target)))];
+
+		modulationMatrix.setSource(lfoSources[osc], lfos[osc]->render(numSamples, shape));
+		modulationMatrix.setSlot(osc, lfoSources[osc], target, depth);
 	}
 
-	if (buffer.getNumChannels() > 0)
+	modulationMatrix.process(numControlPoints);
+}
+
+bool NewProjectAudioProcessor::containsNoteOn(const juce::MidiBuffer& midi) noexcept
+{
+	// Raw bytes, a note-on with velocity 0 is a note-off
+	for (const auto metadata : midi)
+		if (metadata.numBytes >= 3 && (metadata.data[0] & 0xf0) == 0x90 && metadata.data[2] != 0)
+			return true;
+
+	return false;
+}
+
+void NewProjectAudioProcessor::updateIdleState(bool inputQuiet, const juce::AudioBuffer<float>& output) noexcept
+{
+	const int numSamples = output.getNumSamples();
+	bool outputQuiet = inputQuiet;
+
+	for (int channel = 0; channel < output.getNumChannels() && outputQuiet; ++channel)
+		outputQuiet = output.getMagnitude(channel, 0, numSamples) < idleThreshold;
+
+	quietSamples = outputQuiet ? quietSamples + numSamples : 0;
+
+	if (quietSamples < idleHoldSamples)
+		return;
+
+	// What's left of the tail is inaudible, drop it so the next note starts clean
+	fdnReverb.reset();
+	convolutionReverb.reset();
+	reverbFreezer.reset();
+	reverbCrossfadeRemaining = 0;
+	reverbHandoverRemaining = 0;
+
+	quietSamples = 0;
+	idle = true;
+}
+
+void NewProjectAudioProcessor::processReverb(juce::AudioBuffer<float>& buffer, const ParameterValues& params, int interval) noexcept
+{
+	const int numSamples = buffer.getNumSamples();
+	const float* dryWetPoints = modulationMatrix.getPoints(dryWetDestination);
+	const auto engine = chooseReverbEngine(params);
+
+	if (engine != reverbEngine)
 	{
-		float visualizationGain = 2.0f;
-		const float* readPtr = buffer.getReadPointer(0);
+		// The incoming engine starts from silence, not from where it was left
+		if (engine == ReverbEngine::fdn)
+			fdnReverb.reset();
+		else if (engine == ReverbEngine::convolution)
+			convolutionReverb.reset();
+		else
+			reverbFreezer.reset();
+
+		const bool sameRoom = engine != ReverbEngine::convolution && reverbEngine != ReverbEngine::convolution;
+		reverbCrossfadeRemaining = sameRoom ? 0 : reverbCrossfadeLength;
+
+		// As long as the outgoing room can still ring
+		const double tailSeconds = ReverbFreezer::getImpulseSeconds(getSampleRate(),
+			modulationMatrix.getPoints(predelayDestination)[0], modulationMatrix.getPoints(decayDestination)[0]);
+		reverbHandoverRemaining = sameRoom ? juce::jmax(1, static_cast<int>(tailSeconds * getSampleRate())) : 0;
+
+		outgoingReverbEngine = reverbEngine;
+		reverbEngine = engine;
+		reverbFrozen = engine == ReverbEngine::frozen;
+	}
 
-		for (int i = 0; i < numSamples; ++i)
-		{
-			// Scale the sample just for visualization purposes
-			float scaledSample = readPtr[i] * visualizationGain;
+	if (reverbCrossfadeRemaining <= 0 && reverbHandoverRemaining <= 0)
+	{
+		processReverbEngine(reverbEngine, buffer, dryWetPoints, interval);
+		return;
+	}
 
-			fifoBuffer.setSample(0, fifoIndex % fifoSize, scaledSample);
-			fifoIndex++;
+	const int numChannels = juce::jmin(buffer.getNumChannels(), reverbCrossfadeBuffer.getNumChannels());
+	reverbCrossfadeBuffer.setSize(numChannels, numSamples, false, false, true);
+
+	if (reverbHandoverRemaining > 0)
+	{
+		// The outgoing tail on its own (dry/wet still applies), under the incoming engine
+		reverbCrossfadeBuffer.clear();
+		processReverbEngine(outgoingReverbEngine, reverbCrossfadeBuffer, dryWetPoints, interval);
+		processReverbEngine(reverbEngine, buffer, dryWetPoints, interval);
+
+		for (int channel = 0; channel < numChannels; ++channel)
+			buffer.addFrom(channel, 0, reverbCrossfadeBuffer, channel, 0, numSamples);
+
+		reverbHandoverRemaining = juce::jmax(0, reverbHandoverRemaining - numSamples);
+		return;
+	}
+
+	// The outgoing engine gets a copy of the input, the incoming one the buffer itself
+	for (int channel = 0; channel < numChannels; ++channel)
+		reverbCrossfadeBuffer.copyFrom(channel, 0, buffer, channel, 0, numSamples);
+
+	processReverbEngine(outgoingReverbEngine, reverbCrossfadeBuffer, dryWetPoints, interval);
+	processReverbEngine(reverbEngine, buffer, dryWetPoints, interval);
+
+	for (int channel = 0; channel < numChannels; ++channel)
+	{
+		auto* channelData = buffer.getWritePointer(channel);
+		const auto* outgoing = reverbCrossfadeBuffer.getReadPointer(channel);
+
+		for (int sample = 0; sample < numSamples; ++sample)
+		{
+			const float fadeOut = static_cast<float>(juce::jmax(0, reverbCrossfadeRemaining - sample)) / static_cast<float>(reverbCrossfadeLength);
+			channelData[sample] += (outgoing[sample] - channelData[sample]) * fadeOut;
 		}
 	}
+
+	reverbCrossfadeRemaining = juce::jmax(0, reverbCrossfadeRemaining - numSamples);
 }
 
-void NewProjectAudioProcessor::addMidiMessage(const juce::MidiMessage& message)
+NewProjectAudioProcessor::ReverbEngine NewProjectAudioProcessor::chooseReverbEngine(const ParameterValues& params) noexcept
 {
-	int start1, size1, start2, size2;
-	midiFifo.prepareToWrite(1, start1, size1, start2, size2);
-
-	bool written = false;
+	// Convolution needs an impulse response, the FDN stands in until there is one
+	if (params.reverbMode > 0.5f)
+		return convolutionReverb.hasImpulseResponse() ? ReverbEngine::convolution : ReverbEngine::fdn;
+
+	if (!reverbFreezing)
+		return ReverbEngine::fdn;
+
+	// Anything modulating the FDN, an OSC panel or any other slot, keeps it live
+	for (int destination : { predelayDestination, decayDestination, diffusionDestination, highCutoffDestination, lowCutoffDestination })
+		if (modulationMatrix.isModulated(destination))
+			return ReverbEngine::fdn;
+
+	ReverbFreezer::Settings settings;
+	settings.predelay = modulationMatrix.getPoints(predelayDestination)[0];
+	settings.decay = modulationMatrix.getPoints(decayDestination)[0];
+	settings.diffusion = modulationMatrix.getPoints(diffusionDestination)[0];
+	settings.hpCutoff = modulationMatrix.getPoints(highCutoffDestination)[0];
+	settings.lpCutoff = modulationMatrix.getPoints(lowCutoffDestination)[0];
+
+	// Live until the worker has rendered these settings
+	reverbFreezer.request(settings);
+	return reverbFreezer.isFrozen(settings) ? ReverbEngine::frozen : ReverbEngine::fdn;
+}
 
-	if (size1 > 0)
+void NewProjectAudioProcessor::processReverbEngine(ReverbEngine engine, juce::AudioBuffer<float>& target, const float* dryWetPoints, int interval) noexcept
+{
+	if (engine == ReverbEngine::convolution)
 	{
-		midiBuffer[start1] = message;
-		midiFifo.finishedWrite(1);
-		written = true;
+		convolutionReverb.process(target, dryWetPoints, interval);
+		return;
 	}
-	else if (size2 > 0)
+
+	if (engine == ReverbEngine::frozen)
 	{
-		midiBuffer[start2] = message;
-		midiFifo.finishedWrite(1);
-		written = true;
+		reverbFreezer.process(target, dryWetPoints, interval);
+		return;
 	}
+
+	FDNReverb::ControlPoints controls;
+	controls.predelay = modulationMatrix.getPoints(predelayDestination);
+	controls.decay = modulationMatrix.getPoints(decayDestination);
+	controls.diffusion = modulationMatrix.getPoints(diffusionDestination);
+	controls.dryWet = dryWetPoints;
+	controls.interval = interval;
+
+	// HPF and LPF (cutoff changes ramp inside the reverb)
+	auto hpCutoff = modulationMatrix.getPoints(highCutoffDestination)[0];
+	auto lpCutoff = modulationMatrix.getPoints(lowCutoffDestination)[0];
+
+	// Stereo reverb and dry/wet mix, straight into the buffer
+	fdnReverb.process(target, controls, hpCutoff, lpCutoff);
+}
+
+void NewProjectAudioProcessor::useReverbAsImpulseResponse()
+{
+	// Straight from the parameters, the snapshot belongs to the audio thread
+	auto value = [this](const char* parameterID) { return apvts.getRawParameterValue(parameterID)->load(); };
+
+	ReverbFreezer::Settings settings;
+	settings.predelay = value("PREDELAY");
+	settings.decay = value("DECAY");
+	settings.diffusion = value("DIFFUSION");
+	settings.hpCutoff = value("HIGH_CUTOFF");
+	settings.lpCutoff = value("LOW_CUTOFF");
+
+	// Up to a few seconds of FDN and the FFTs after it, so on the freezer's
+	// worker rather than the message thread
+	reverbFreezer.capture(settings, [this](const juce::AudioBuffer<float>& impulse, double sampleRate)
+	{
+		// At the FDN's own level, so switching modes doesn't jump
+		const juce::ScopedLock sl(impulseResponseLock);
+		convolutionReverb.setImpulseResponse(impulse, sampleRate, false);
+	});
+}
+
+bool NewProjectAudioProcessor::loadImpulseResponse(const juce::File& file)
+{
+	const juce::ScopedLock sl(impulseResponseLock);
+	return convolutionReverb.loadImpulseResponse(file);
+}
+
+bool NewProjectAudioProcessor::setModulation(int slot, ModulationMatrix::Source source, const juce::String& parameterID, float depth)
+{
+	const int destination = modulationMatrix.findDestination(parameterID);
+
+	if (slot < firstFreeModulationSlot || slot >= ModulationMatrix::maxSlots || destination < 0)
+		return false;
+
+	modulationMatrix.setSlot(slot, source, destination, depth);
+	return true;
+}
+
+int NewProjectAudioProcessor::getGuiEventOffset(double eventMs, int numSamples) const noexcept
+{
+	// Events that arrived while the previous block was being played go into this
+	// one at the same distance from its start. That's a constant block of latency
+	// instead of every note snapping to a block boundary
+	if (previousBlockStartMs <= 0.0 || numSamples <= 0)
+		return 0;
+
+	const auto offset = juce::roundToInt((eventMs - previousBlockStartMs) * getSampleRate() * 0.001);
+	return juce::jlimit(0, numSamples - 1, offset);
+}
+
+void NewProjectAudioProcessor::addMidiMessage(const juce::MidiMessage& message)
+{
+	keyboardQueue.push(message, message.getTimeStamp());
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout NewProjectAudioProcessor::createParameters()
@@ -367,6 +583,10 @@ juce::AudioProcessorValueTreeState::ParameterLayout NewProjectAudioProcessor::cr
 		"GAIN", "Gain", juce::NormalisableRange<float>(0.0f, 3.0f, 0.01f, 0.5f), 1.5f));
 	params.push_back(std::make_unique<juce::AudioParameterFloat>(
 		"PITCH_BEND", "Pitch Bend", juce::NormalisableRange<float>(-2.0f, 2.0f), 0.0f));
+	params.push_back(std::make_unique<juce::AudioParameterChoice>("RESAMPLER_QUALITY", "Resampler Quality",
+		juce::StringArray("Linear", "Hermite", "Sinc"), 2));
+	params.push_back(std::make_unique<juce::AudioParameterInt>(
+		"POLYPHONY", "Polyphony", 1, Synth::maxVoices, Synth::defaultNumVoices));
 	params.push_back(std::make_unique<juce::AudioParameterBool>(
 		"ARPEGGIATOR", "Arpeggiator", false));
 
@@ -381,6 +601,8 @@ juce::AudioProcessorValueTreeState::ParameterLayout NewProjectAudioProcessor::cr
 		"DIFFUSION", "Diffusion", juce::NormalisableRange<float>(0.0f, 1.0f, 0.01f), 0.5f));
 	params.push_back(std::make_unique<juce::AudioParameterBool>(
 		"REVERB_ENABLED", "Reverb Enabled", false));
+	params.push_back(std::make_unique<juce::AudioParameterChoice>("REVERB_MODE", "Reverb Mode",
+		juce::StringArray("Algorithmic", "Impulse Response"), 0));
 
 
 	// Oscillator 1 Parameters
@@ -13,7 +13,13 @@
 #include <juce_audio_basics/juce_audio_basics.h>
 #include "ReverbControls.h"
 #include "FDNReverb.h"
+#include "ConvolutionReverb.h"
+#include "ReverbFreezer.h"
 #include "LFO.h"
+#include "ModulationMatrix.h"
+#include "ParameterSnapshot.h"
+#include "ScopeFifo.h"
+#include "MidiEventQueue.h"
 
 //==============================================================================
 /**
@@ -22,10 +28,8 @@ class NewProjectAudioProcessor  : public juce::AudioProcessor
 {
 public:
 
-    // FIFO
-    juce::AudioSampleBuffer fifoBuffer;
-    std::atomic<int> fifoIndex{ 0 };
-    static constexpr int fifoSize = 48000; // Adjust size as needed
+    // Oscilloscope feed, written by the audio thread and read by the editor
+    ScopeFifo scopeFifo{ 48000 };
 
     //==============================================================================
     NewProjectAudioProcessor();
@@ -40,6 +44,7 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void setNonRealtime (bool isNonRealtime) noexcept override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -65,24 +70,138 @@ public:
     void setStateInformation (const void* data, int sizeInBytes) override;
 
 	//==============================================================================
+    // From the editor's keyboard. The timestamp is getMillisecondCounterHiRes()
+    // when it was played, processBlock turns it into a sample offset.
+    // Message thread only, never blocks or allocates
     void addMidiMessage(const juce::MidiMessage& message);
 
+    // Keyboard events dropped because the queue was full (note-offs never are)
+    int getNumDroppedMidiEvents() const { return keyboardQueue.getNumOverflows(); }
+
 	// ==============================================================================
     void setGain(float newGain) { gain = newGain; }
     float getGain() const { return gain; }
 
+    // Routes a modulation source to any float parameter, on top of the OSC panels'
+    // LFOs (which own the slots below firstFreeModulationSlot). depth is a fraction
+    // of the parameter's range, 0 clears the slot. False for an unknown parameter or slot
+    bool setModulation(int slot, ModulationMatrix::Source source, const juce::String& parameterID, float depth);
+    static constexpr int firstFreeModulationSlot = 2;
+
+    // Samples between LFO control points (see ControlRate.h), from the next prepareToPlay
+    void setModulationControlInterval(int samples) { controlInterval = juce::jlimit(ControlRate::minInterval, ControlRate::maxInterval, samples); }
+
+    // Tiny noise floor in the reverb tail instead of hard zeros (off by default)
+    void setReverbTailDither(bool shouldDither) { fdnReverb.setTailDither(shouldDither); }
+
+    // The FDN's feedback saturation at 1x (default), 2x or 4x: less aliasing, more CPU
+    void setReverbOversampling(int factor) { fdnReverb.setOversampling(factor); }
+
+    // The impulse response for REVERB_MODE's convolution engine, message thread.
+    // False if the file can't be read. Until there is one, the FDN plays instead
+    bool loadImpulseResponse(const juce::File& file);
+
+    // Renders the FDN at the current settings into the convolution engine's impulse
+    // response. Returns straight away, the render happens in the background
+    void useReverbAsImpulseResponse();
+
+    // Convolution tail blocks that weren't ready in time (played without their tail)
+    int getNumMissedConvolutionBlocks() const { return convolutionReverb.getNumMissedBlocks(); }
+
+    // While nothing modulates the FDN's parameters, render it into an impulse
+    // response in the background and play that instead, which costs far less.
+    // Any change to them goes back to the live FDN. Off by default
+    void setReverbFreezing(bool shouldFreeze) { reverbFreezing = shouldFreeze; }
+    bool isReverbFrozen() const { return reverbFrozen; }
+
+    // Frames the sample streamer couldn't deliver in time (played as silence)
+    int getStreamUnderrunFrames() const { return synth.getStreamer().getNumUnderrunFrames(); }
+
+    // Samples load in the background, notes stay silent until they're in
+    bool areSamplesLoaded() const { return synth.areSamplesLoaded(); }
+    float getSampleLoadingProgress() const { return synth.getLoadingProgress(); }
+
+    // The pool's copy at the host rate, built after prepareToPlay reports a new one
+    bool areSamplesAtHostRate() const { return synth.areSamplesAtHostRate(); }
+
+    // Voices sounding right now, and how many the CPU budget has cut short
+    int getNumActiveVoices() const { return synth.getNumActiveVoices(); }
+    int getNumVoicesDropped() const { return synth.getNumVoicesDropped(); }
+
+    // Voices that go inaudible end early, below this level (dBFS, Synth::cullOff for never)
+    void setVoiceCullThreshold(float decibels) { synth.setCullThreshold(decibels); }
+    int getNumVoicesCulled() const { return synth.getNumVoicesCulled(); }
+
+    // Nothing playing and the reverb tail gone: blocks skip everything but the
+    // MIDI bookkeeping until the next note-on
+    bool isIdle() const { return idle.load(std::memory_order_relaxed); }
+
 	//==============================================================================
     juce::AudioProcessorValueTreeState apvts;
 
 
 private:
     //==============================================================================
+    // Every parameter's atomic, resolved once, read once per block (after apvts)
+    ParameterSnapshot parameters{ apvts };
+
     Synth synth;
     FDNReverb fdnReverb;
+    ConvolutionReverb convolutionReverb;
+    juce::CriticalSection impulseResponseLock; // Loads and prepare() take turns, see ConvolutionReverb
     LFO lfo1, lfo2;
-
-    juce::AbstractFifo midiFifo{ 1024 }; // Size the FIFO as needed
-    std::vector<juce::MidiMessage> midiBuffer;
+    int controlInterval = ControlRate::defaultInterval;
+
+    // Every parameter the audio thread reads goes through the matrix. Destination
+    // indices are resolved once, in the constructor
+    ModulationMatrix modulationMatrix;
+    MidiModulationSources midiModulation;
+    int gainDestination = -1, pitchBendDestination = -1, dryWetDestination = -1;
+    int highCutoffDestination = -1, lowCutoffDestination = -1;
+    int predelayDestination = -1, decayDestination = -1, diffusionDestination = -1;
+    std::array<int, 2> oscDepthDestinations{}, oscShapeDestinations{};
+    std::array<int, 3> oscTargetDestinations{};
+
+    void updateModulation(const ParameterValues& params, int numSamples, int numControlPoints) noexcept;
+
+    // The engine the reverb runs on. The frozen FDN (see ReverbFreezer) only
+    // stands in for the live one while its parameters are held still
+    enum class ReverbEngine { fdn, convolution, frozen };
+    ReverbEngine reverbEngine = ReverbEngine::fdn, outgoingReverbEngine = ReverbEngine::fdn;
+
+    ReverbFreezer reverbFreezer;
+    std::atomic<bool> reverbFreezing{ false }, reverbFrozen{ false };
+
+    // Switching to a different room crossfades, the outgoing engine running on
+    // a copy of the input. The live and frozen FDN are the same room, so there
+    // the outgoing one gets silence and rings out under the incoming one instead
+    static constexpr double reverbCrossfadeSeconds = 0.025;
+    int reverbCrossfadeLength = 1, reverbCrossfadeRemaining = 0;
+    int reverbHandoverRemaining = 0;
+    juce::AudioBuffer<float> reverbCrossfadeBuffer;
+
+    ReverbEngine chooseReverbEngine(const ParameterValues& params) noexcept;
+    void processReverbEngine(ReverbEngine engine, juce::AudioBuffer<float>& target, const float* dryWetPoints, int interval) noexcept;
+    void processReverb(juce::AudioBuffer<float>& buffer, const ParameterValues& params, int interval) noexcept;
+
+    // Idle once the synth's output and the reverb's both stay under idleThreshold
+    // for idleHoldSeconds, which outlasts the longest predelay (the tail hasn't
+    // reached the output yet then). Ends at the next note-on
+    static constexpr float idleThreshold = 1.0e-5f; // -100 dBFS
+    static constexpr double idleHoldSeconds = 0.25;
+    int idleHoldSamples = 1, quietSamples = 0;
+    std::atomic<bool> idle{ false };
+
+    static bool containsNoteOn(const juce::MidiBuffer& midi) noexcept;
+    void updateIdleState(bool inputQuiet, const juce::AudioBuffer<float>& output) noexcept;
+
+    // Editor keyboard to audio thread, and the block's merged MIDI
+    MidiEventQueue keyboardQueue;
+    juce::MidiBuffer liveMidi;
+
+    // When the last block started, for placing the editor's notes inside the next one
+    double previousBlockStartMs = 0.0;
+    int getGuiEventOffset(double eventMs, int numSamples) const noexcept;
 
     float gain = 1.0f;
 
@@ -0,0 +1,386 @@
+/*
+  ==============================================================================
+
+    Resampler.cpp
+    Created: 20 Oct 2026 10:12:31am
+    Author:  mikey
+
+  ==============================================================================
+*/
+
+#include "Resampler.h"
+
+#if JUCE_USE_SSE_INTRINSICS
+ #include <xmmintrin.h>
+#elif JUCE_USE_ARM_NEON
+ #include <arm_neon.h>
+#endif
+
+namespace
+{
+    constexpr int sincTaps = 16;    // Tap k reads source[k - 7]
+    constexpr int sincPhases = 512; // Fractional positions per frame
+    constexpr double sincCutoff = 0.92; // Of Nyquist, at steps up to 1
+    constexpr int sincTablesPerOctave = 8;
+    constexpr int numSincTables = 2 * sincTablesPerOctave + 1; // Steps up to 4, CustomSamplerVoice::maxStep
+    constexpr double kaiserBeta = 7.5;
+
+    double besselI0(double x) noexcept
+    {
+        double sum = 1.0, term = 1.0;
+        for (int k = 1; k < 32; ++k)
+        {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+        }
+        return sum;
+    }
+
+    // Coefficients for each phase plus the difference to the next one, so a
+    // fractional phase is coefficients + fraction * deltas
+    struct SincTable
+    {
+        explicit SincTable(double cutoff)
+        {
+            const double halfLength = sincTaps / 2.0;
+            std::vector<float> phases(static_cast<size_t>((sincPhases + 1) * sincTaps));
+
+            for (int phase = 0; phase <= sincPhases; ++phase)
+            {
+                const double fraction = static_cast<double>(phase) / sincPhases;
+                float* row = phases.data() + phase * sincTaps;
+                double sum = 0.0;
+
+                for (int tap = 0; tap < sincTaps; ++tap)
+                {
+                    const double x = (tap - (Resampler::maxTapsBefore)) - fraction;
+                    const double window = std::abs(x) < halfLength
+                        ? besselI0(kaiserBeta * std::sqrt(1.0 - (x / halfLength) * (x / halfLength))) / besselI0(kaiserBeta)
+                        : 0.0;
+                    const double argument = juce::MathConstants<double>::pi * cutoff * x;
+                    const double sinc = x == 0.0 ? 1.0 : std::sin(argument) / argument;
+
+                    row[tap] = static_cast<float>(sinc * window);
+                    sum += row[tap];
+                }
+
+                // Unity gain at DC for every phase
+                for (int tap = 0; tap < sincTaps; ++tap)
+                    row[tap] = static_cast<float>(row[tap] / sum);
+            }
+
+            coefficients.assign(phases.begin(), phases.end() - sincTaps);
+            deltas.resize(coefficients.size());
+
+            for (size_t i = 0; i < deltas.size(); ++i)
+                deltas[i] = phases[i + sincTaps] - phases[i];
+        }
+
+        std::vector<float> coefficients, deltas;
+    };
+
+    // One table per eighth of an octave of step, the cutoff dropping with it
+    const std::vector<SincTable>& getSincTables()
+    {
+        static const auto tables = []
+        {
+            std::vector<SincTable> result;
+            result.reserve(numSincTables);
+
+            for (int i = 0; i < numSincTables; ++i)
+                result.emplace_back(sincCutoff / std::exp2(static_cast<double>(i) / sincTablesPerOctave));
+
+            return result;
+        }();
+
+        return tables;
+    }
+
+    // Above a step of 1 the source's top end would land past the output's
+    // Nyquist. Rounding up to the next table errs on the dull side, not aliasing
+    const SincTable& getSincTable(double step) noexcept
+    {
+        const int index = step <= 1.0 ? 0
+            : juce::jmin(numSincTables - 1, static_cast<int>(std::ceil(std::log2(step) * sincTablesPerOctave - 1.0e-9)));
+
+        return getSincTables()[static_cast<size_t>(index)];
+    }
+
+    //==============================================================================
+    // Positions run as 32.32 fixed point inside the kernels, so the integer frame
+    // and the fraction (and the sinc table phase) are shifts rather than conversions
+    constexpr int fractionBits = 32;
+    constexpr double fixedScale = static_cast<double>(juce::int64(1) << fractionBits);
+    constexpr float fractionScale = static_cast<float>(1.0 / fixedScale);
+
+    double processLinear(const float* source, double position, double step, float* destination, int numSamples) noexcept
+    {
+        auto fixedPosition = static_cast<juce::uint64>(position * fixedScale);
+        const auto fixedStep = static_cast<juce::uint64>(step * fixedScale);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float* x = source + (fixedPosition >> fractionBits);
+            const float alpha = static_cast<float>(static_cast<juce::uint32>(fixedPosition)) * fractionScale;
+
+            destination[i] = x[0] + alpha * (x[1] - x[0]);
+            fixedPosition += fixedStep;
+        }
+
+        return static_cast<double>(fixedPosition) / fixedScale;
+    }
+
+    double processHermite(const float* source, double position, double step, float* destination, int numSamples) noexcept
+    {
+        auto fixedPosition = static_cast<juce::uint64>(position * fixedScale);
+        const auto fixedStep = static_cast<juce::uint64>(step * fixedScale);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float* x = source + (fixedPosition >> fractionBits);
+            const float t = static_cast<float>(static_cast<juce::uint32>(fixedPosition)) * fractionScale;
+
+            const float c1 = 0.5f * (x[1] - x[-1]);
+            const float c2 = x[-1] - 2.5f * x[0] + 2.0f * x[1] - 0.5f * x[2];
+            const float c3 = 0.5f * (x[2] - x[-1]) + 1.5f * (x[0] - x[1]);
+            destination[i] = ((c3 * t + c2) * t + c1) * t + x[0];
+            fixedPosition += fixedStep;
+        }
+
+        return static_cast<double>(fixedPosition) / fixedScale;
+    }
+
+    constexpr int phaseBits = 9;
+    static_assert((1 << phaseBits) == sincPhases, "sincPhases must match phaseBits");
+
+    double processSinc(const float* source, double position, double step, float* destination, int numSamples) noexcept
+    {
+        const auto& table = getSincTable(step);
+        const float* coefficients = table.coefficients.data();
+        const float* deltas = table.deltas.data();
+
+        constexpr float phaseFractionScale = 1.0f / static_cast<float>(juce::int64(1) << (fractionBits - phaseBits));
+
+        auto fixedPosition = static_cast<juce::uint64>(position * fixedScale);
+        const auto fixedStep = static_cast<juce::uint64>(step * fixedScale);
+
+        // Where the taps start, the table row, and how far towards the next row
+        const auto locate = [&](const float*& x, const float*& c, const float*& d, float& phaseFraction) noexcept
+        {
+            const auto index = static_cast<int>(fixedPosition >> fractionBits);
+            const auto fraction = static_cast<juce::uint32>(fixedPosition);
+            const auto phase = static_cast<int>(fraction >> (fractionBits - phaseBits));
+
+            x = source + index - Resampler::maxTapsBefore;
+            c = coefficients + phase * sincTaps;
+            d = deltas + phase * sincTaps;
+            phaseFraction = static_cast<float>(fraction & ((1u << (fractionBits - phaseBits)) - 1)) * phaseFractionScale;
+            fixedPosition += fixedStep;
+        };
+
+        int i = 0;
+
+       #if JUCE_USE_SSE_INTRINSICS
+        const auto dot = [](const float* x, const float* c, const float* d, float phaseFraction) noexcept
+        {
+            const __m128 f = _mm_set1_ps(phaseFraction);
+            __m128 sum = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(c), _mm_mul_ps(f, _mm_loadu_ps(d))), _mm_loadu_ps(x));
+
+            for (int tap = 4; tap < sincTaps; tap += 4)
+            {
+                const __m128 coefficient = _mm_add_ps(_mm_loadu_ps(c + tap), _mm_mul_ps(f, _mm_loadu_ps(d + tap)));
+                sum = _mm_add_ps(sum, _mm_mul_ps(coefficient, _mm_loadu_ps(x + tap)));
+            }
+
+            return sum;
+        };
+
+        // Four outputs at a time, so their partial sums reduce with one transpose
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            const float *x, *c, *d;
+            float f;
+
+            locate(x, c, d, f); __m128 s0 = dot(x, c, d, f);
+            locate(x, c, d, f); __m128 s1 = dot(x, c, d, f);
+            locate(x, c, d, f); __m128 s2 = dot(x, c, d, f);
+            locate(x, c, d, f); __m128 s3 = dot(x, c, d, f);
+
+            _MM_TRANSPOSE4_PS(s0, s1, s2, s3);
+            _mm_storeu_ps(destination + i, _mm_add_ps(_mm_add_ps(s0, s1), _mm_add_ps(s2, s3)));
+        }
+       #elif JUCE_USE_ARM_NEON
+        const auto dot = [](const float* x, const float* c, const float* d, float phaseFraction) noexcept
+        {
+            const float32x4_t f = vdupq_n_f32(phaseFraction);
+            float32x4_t sum = vmulq_f32(vmlaq_f32(vld1q_f32(c), f, vld1q_f32(d)), vld1q_f32(x));
+
+            for (int tap = 4; tap < sincTaps; tap += 4)
+                sum = vmlaq_f32(sum, vmlaq_f32(vld1q_f32(c + tap), f, vld1q_f32(d + tap)), vld1q_f32(x + tap));
+
+            return sum;
+        };
+
+        for (; i + 4 <= numSamples; i += 4)
+        {
+            const float *x, *c, *d;
+            float f;
+
+            locate(x, c, d, f); const float32x4_t s0 = dot(x, c, d, f);
+            locate(x, c, d, f); const float32x4_t s1 = dot(x, c, d, f);
+            locate(x, c, d, f); const float32x4_t s2 = dot(x, c, d, f);
+            locate(x, c, d, f); const float32x4_t s3 = dot(x, c, d, f);
+
+            // Pairwise adds leave lane k holding the whole sum for output k
+            const float32x4_t s01 = vcombine_f32(vpadd_f32(vget_low_f32(s0), vget_high_f32(s0)),
+                                                 vpadd_f32(vget_low_f32(s1), vget_high_f32(s1)));
+            const float32x4_t s23 = vcombine_f32(vpadd_f32(vget_low_f32(s2), vget_high_f32(s2)),
+                                                 vpadd_f32(vget_low_f32(s3), vget_high_f32(s3)));
+            vst1q_f32(destination + i, vcombine_f32(vpadd_f32(vget_low_f32(s01), vget_high_f32(s01)),
+                                                    vpadd_f32(vget_low_f32(s23), vget_high_f32(s23))));
+        }
+       #endif
+
+        for (; i < numSamples; ++i)
+        {
+            const float *x, *c, *d;
+            float f;
+            locate(x, c, d, f);
+
+            float sum = 0.0f;
+            for (int tap = 0; tap < sincTaps; ++tap)
+                sum += (c[tap] + f * d[tap]) * x[tap];
+
+            destination[i] = sum;
+        }
+
+        return static_cast<double>(fixedPosition) / fixedScale;
+    }
+}
+
+//==============================================================================
+int Resampler::getTapsBefore(Quality quality) noexcept
+{
+    switch (quality)
+    {
+        case Quality::hermite: return 1;
+        case Quality::sinc:    return maxTapsBefore;
+        case Quality::linear:
+        default:               return 0;
+    }
+}
+
+int Resampler::getTapsAfter(Quality quality) noexcept
+{
+    switch (quality)
+    {
+        case Quality::hermite: return 2;
+        case Quality::sinc:    return maxTapsAfter;
+        case Quality::linear:
+        default:               return 1;
+    }
+}
+
+double Resampler::process(Quality quality, const float* source, double position, double step,
+                          float* destination, int numSamples) noexcept
+{
+    // Playing at the source rate from a whole frame is just a copy
+    if (step == 1.0 && position == static_cast<double>(static_cast<int>(position)))
+    {
+        juce::FloatVectorOperations::copy(destination, source + static_cast<int>(position), numSamples);
+        return position + numSamples;
+    }
+
+    switch (quality)
+    {
+        case Quality::hermite: return processHermite(source, position, step, destination, numSamples);
+        case Quality::sinc:    return processSinc(source, position, step, destination, numSamples);
+        case Quality::linear:
+        default:               return processLinear(source, position, step, destination, numSamples);
+    }
+}
+
+void Resampler::prepareTables()
+{
+    getSincTables();
+}
+
+//==============================================================================
+namespace
+{
+    constexpr int offlineTaps = 64;       // At unity ratio, scaled up when downsampling
+    constexpr int offlinePhases = 1024;
+    constexpr double offlineCutoff = 0.95;
+    constexpr double offlineKaiserBeta = 9.0;
+}
+
+Resampler::Offline::Offline(double stepToUse)
+    : step(stepToUse)
+{
+    jassert(step > 0.0);
+
+    // Going down in rate the cutoff has to drop below the new Nyquist, and the
+    // kernel gets proportionally longer to keep the same transition band
+    const double cutoff = offlineCutoff * juce::jmin(1.0, 1.0 / step);
+    numTaps = (static_cast<int>(std::ceil(offlineTaps * juce::jmax(1.0, step))) + 3) & ~3;
+    tapsBefore = numTaps / 2 - 1;
+
+    const double halfLength = numTaps / 2.0;
+    table.resize(static_cast<size_t>((offlinePhases + 1) * numTaps));
+    std::vector<double> taps(static_cast<size_t>(numTaps));
+
+    for (int phase = 0; phase <= offlinePhases; ++phase)
+    {
+        const double fraction = static_cast<double>(phase) / offlinePhases;
+        float* row = table.data() + phase * numTaps;
+        double sum = 0.0;
+
+        for (int tap = 0; tap < numTaps; ++tap)
+        {
+            const double x = (tap - tapsBefore) - fraction;
+            const double window = std::abs(x) < halfLength
+                ? besselI0(offlineKaiserBeta * std::sqrt(1.0 - (x / halfLength) * (x / halfLength))) / besselI0(offlineKaiserBeta)
+                : 0.0;
+            const double argument = juce::MathConstants<double>::pi * cutoff * x;
+
+            taps[static_cast<size_t>(tap)] = (x == 0.0 ? 1.0 : std::sin(argument) / argument) * window;
+            sum += taps[static_cast<size_t>(tap)];
+        }
+
+        for (int tap = 0; tap < numTaps; ++tap)
+            row[tap] = static_cast<float>(taps[static_cast<size_t>(tap)] / sum);
+    }
+}
+
+juce::int64 Resampler::Offline::getOutputLength(juce::int64 sourceLength) const noexcept
+{
+    // Every output position stays before the last frame, like a voice's playhead
+    return sourceLength > 1 ? static_cast<juce::int64>(static_cast<double>(sourceLength - 1) / step) + 1 : 0;
+}
+
+void Resampler::Offline::process(const float* source, juce::int64 sourceLength,
+                                 float* destination, juce::int64 numSamples) const
+{
+    // Silence either side so the kernel never needs a bounds check
+    std::vector<float> padded(static_cast<size_t>(sourceLength + numTaps * 2), 0.0f);
+    std::copy_n(source, sourceLength, padded.begin() + numTaps);
+
+    for (juce::int64 i = 0; i < numSamples; ++i)
+    {
+        const double position = static_cast<double>(i) * step;
+        const auto index = static_cast<juce::int64>(position);
+        const double phasePosition = (position - static_cast<double>(index)) * offlinePhases;
+        const auto phase = juce::jmin(offlinePhases - 1, static_cast<int>(phasePosition));
+        const auto phaseFraction = static_cast<float>(phasePosition - phase);
+
+        const float* x = padded.data() + numTaps + index - tapsBefore;
+        const float* c0 = table.data() + phase * numTaps;
+        const float* c1 = c0 + numTaps;
+
+        double sum = 0.0;
+        for (int tap = 0; tap < numTaps; ++tap)
+            sum += static_cast<double>((c0[tap] + phaseFraction * (c1[tap] - c0[tap])) * x[tap]);
+
+        destination[i] = static_cast<float>(sum);
+    }
+}
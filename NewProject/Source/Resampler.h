@@ -0,0 +1,67 @@
+/*
+  ==============================================================================
+
+    Resampler.h
+    Created: 20 Oct 2026 10:12:31am
+    Author:  mikey
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+// Variable-rate interpolation for the sampler voices.
+// All kernels read source frames around floor(position) and render numSamples
+// outputs, stepping position by 'step' source frames per output sample:
+//  - linear:  2 taps
+//  - hermite: 4-point, 3rd-order Hermite (Catmull-Rom)
+//  - sinc:    16-tap Kaiser-windowed sinc, from polyphase tables shared by
+//             every voice, with linear interpolation between phases. Above a
+//             step of 1 the cutoff follows the step (in eighth-octave tables),
+//             so bending up doesn't alias
+// A step of exactly 1 on a whole frame is a plain copy for every quality.
+namespace Resampler
+{
+    enum class Quality { linear = 0, hermite, sinc };
+
+    // Frames a kernel reads before floor(position) and after it (inclusive)
+    int getTapsBefore(Quality quality) noexcept;
+    int getTapsAfter(Quality quality) noexcept;
+
+    // The most any quality reads, for sizing source windows
+    static constexpr int maxTapsBefore = 7;
+    static constexpr int maxTapsAfter = 8;
+
+    // 'source' points at the frame floor(position) is measured from, position is
+    // fractional (>= 0). Returns the position after the last output sample
+    double process(Quality quality, const float* source, double position, double step,
+                   float* destination, int numSamples) noexcept;
+
+    // Builds the shared sinc tables. Called off the audio thread so the first
+    // voice to use it doesn't pay for (or allocate) it
+    void prepareTables();
+
+    //==============================================================================
+    // A much longer kernel for resampling whole samples ahead of time, far too
+    // slow for a voice. The cutoff follows the ratio, so going down in rate
+    // doesn't alias either. 'step' is source frames per output frame
+    class Offline
+    {
+    public:
+        explicit Offline(double step);
+
+        double getStep() const noexcept { return step; }
+
+        // Outputs for a source of sourceLength frames
+        juce::int64 getOutputLength(juce::int64 sourceLength) const noexcept;
+
+        // Frames outside the source read as silence
+        void process(const float* source, juce::int64 sourceLength, float* destination, juce::int64 numSamples) const;
+
+    private:
+        double step = 1.0;
+        int numTaps = 0, tapsBefore = 0;
+        std::vector<float> table; // (phases + 1) rows of numTaps
+    };
+}
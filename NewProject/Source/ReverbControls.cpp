@@ -79,6 +79,14 @@ ReverbControls::ReverbControls(juce::AudioProcessorValueTreeState& apvts): apvts
 
 	addAndMakeVisible(reverbButton);
 
+    reverbModeBox.addItem("FDN", 1);
+    reverbModeBox.addItem("IR", 2);
+    reverbModeBox.setSelectedId(1);
+    addAndMakeVisible(reverbModeBox);
+
+    impulseResponseButton.onClick = [this] { showImpulseResponseMenu(); };
+    addAndMakeVisible(impulseResponseButton);
+
     // =================== Look and feel ==========================
 
     knobLookAndFeel = std::make_unique<Knob>();
@@ -113,6 +121,9 @@ ReverbControls::ReverbControls(juce::AudioProcessorValueTreeState& apvts): apvts
 
     reverbEnabledAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(
         apvts, "REVERB_ENABLED", reverbButton);
+
+    reverbModeAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        apvts, "REVERB_MODE", reverbModeBox);
 }
 
 
@@ -127,6 +138,35 @@ ReverbControls::~ReverbControls()
     lowCutoffKnob.setLookAndFeel(nullptr);
 }
 
+void ReverbControls::showImpulseResponseMenu()
+{
+    juce::PopupMenu menu;
+    menu.addItem(1, "Load impulse response...", onLoadImpulseResponse != nullptr);
+    menu.addItem(2, "Capture the FDN as it is", onCaptureImpulseResponse != nullptr);
+
+    menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&impulseResponseButton), [this](int result)
+    {
+        if (result == 2)
+        {
+            onCaptureImpulseResponse();
+            reverbModeBox.setSelectedId(2);
+        }
+        else if (result == 1)
+        {
+            impulseResponseChooser = std::make_unique<juce::FileChooser>("Load an impulse response", juce::File(), "*.wav;*.aif;*.aiff;*.flac");
+
+            impulseResponseChooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+                [this](const juce::FileChooser& chooser)
+                {
+                    const auto file = chooser.getResult();
+
+                    if (file.existsAsFile() && onLoadImpulseResponse(file))
+                        reverbModeBox.setSelectedId(2);
+                });
+        }
+    });
+}
+
 void ReverbControls::paint (juce::Graphics& g)
 {
 
@@ -151,6 +191,12 @@ void ReverbControls::resized()
     reverbLabel.setBounds((bounds.getWidth() - reverbLabelWidth - buttonWidth) / 2, 0, reverbLabelWidth, labelHeight);
     reverbButton.setBounds(reverbLabel.getRight(), reverbLabel.getY() + (labelHeight - buttonHeight) / 2, buttonWidth, buttonHeight);
 
+    // Engine choice at the ends of the title row
+    auto modeBoxWidth = 55;
+    auto irButtonWidth = 30;
+    reverbModeBox.setBounds(bounds.getRight() - modeBoxWidth, 0, modeBoxWidth, labelHeight);
+    impulseResponseButton.setBounds(bounds.getX(), 0, irButtonWidth, labelHeight);
+
     // Adjust bounds to leave space for the label and button
     bounds.removeFromTop(labelHeight + extraSpace);
 
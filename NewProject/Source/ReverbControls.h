@@ -27,7 +27,14 @@ public:
     void paint(juce::Graphics&) override;
     void resized() override;
 
+    // The IR button's menu: a file for the convolution mode, or the FDN as it
+    // is now. Both switch the mode over to it
+    std::function<bool(const juce::File&)> onLoadImpulseResponse;
+    std::function<void()> onCaptureImpulseResponse;
+
 private:
+    void showImpulseResponseMenu();
+
     // APVTS Attachments
     std::unique_ptr <juce::AudioProcessorValueTreeState::SliderAttachment> predelayAttachment;
     std::unique_ptr <juce::AudioProcessorValueTreeState::SliderAttachment> decayAttachment;
@@ -36,6 +43,7 @@ private:
     std::unique_ptr <juce::AudioProcessorValueTreeState::ButtonAttachment> reverbEnabledAttachment;
     std::unique_ptr <juce::AudioProcessorValueTreeState::SliderAttachment> highCutoffAttachment;
     std::unique_ptr <juce::AudioProcessorValueTreeState::SliderAttachment> lowCutoffAttachment;
+    std::unique_ptr <juce::AudioProcessorValueTreeState::ComboBoxAttachment> reverbModeAttachment;
 
     juce::Label reverbLabel;
     juce::Slider predelayKnob;
@@ -54,6 +62,11 @@ private:
 
     juce::ToggleButton reverbButton;
 
+    // Algorithmic (FDN) or impulse response (convolution)
+    juce::ComboBox reverbModeBox;
+    juce::TextButton impulseResponseButton{ "IR" };
+    std::unique_ptr<juce::FileChooser> impulseResponseChooser;
+
     std::unique_ptr<ToggleButton> toggleButtonLookAndFeel;
     std::unique_ptr<Knob> knobLookAndFeel;
 
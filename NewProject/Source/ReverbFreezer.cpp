@@ -0,0 +1,176 @@
+/*
+  ==============================================================================
+
+    ReverbFreezer.cpp
+    Created: 26 Oct 2026 9:40:12am
+    Author:  mikey
+
+  ==============================================================================
+*/
+
+#include "ReverbFreezer.h"
+
+ReverbFreezer::ReverbFreezer()
+    : juce::Thread("Liszt reverb freezer")
+{
+    // The FDN's input is mono, its impulse response is per output channel
+    convolution.setMonoInput(true);
+    startThread(juce::Thread::Priority::low);
+}
+
+ReverbFreezer::~ReverbFreezer()
+{
+    // A render checks nothing, at worst this waits for one to finish
+    stopThread(10000);
+}
+
+void ReverbFreezer::prepare(double newSampleRate, int newNumChannels)
+{
+    const juce::ScopedLock sl(renderLock);
+
+    sampleRate = newSampleRate;
+    convolution.prepare(sampleRate, newNumChannels);
+
+    // The audio thread isn't running, the next request starts over
+    frozenVersion.store(0, std::memory_order_release);
+    hasRendered = false;
+    hasRequested = false;
+}
+
+void ReverbFreezer::request(const Settings& settings) noexcept
+{
+    if (hasRequested && settings == lastRequest)
+        return;
+
+    lastRequest = settings;
+    hasRequested = true;
+
+    const auto fields = toFields(settings);
+    for (int i = 0; i < numFields; ++i)
+        requested[static_cast<size_t>(i)].store(fields[static_cast<size_t>(i)], std::memory_order_relaxed);
+
+    numRequests.fetch_add(1, std::memory_order_release);
+    notify();
+}
+
+bool ReverbFreezer::isFrozen(const Settings& settings) noexcept
+{
+    const auto playing = convolution.updateImpulseResponse();
+    const auto version = frozenVersion.load(std::memory_order_acquire);
+
+    if (playing == 0 || version != playing)
+        return false;
+
+    const auto frozenSettings = fromFields(frozen);
+
+    // Still the same version after reading, so the worker didn't start rewriting them meanwhile
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return frozenVersion.load(std::memory_order_relaxed) == version && frozenSettings == settings;
+}
+
+void ReverbFreezer::capture(const Settings& settings, CaptureCallback onRendered)
+{
+    {
+        const juce::ScopedLock sl(captureLock);
+        captureSettings = settings;
+        captureCallback = std::move(onRendered);
+    }
+
+    notify();
+}
+
+void ReverbFreezer::renderImpulse(juce::AudioBuffer<float>& impulse, const Settings& settings) const
+{
+    const double impulseSeconds = getImpulseSeconds(sampleRate, settings.predelay, settings.decay);
+    impulse.setSize(2, static_cast<int>(impulseSeconds * sampleRate));
+    FDNReverb::renderImpulseResponse(impulse, sampleRate, settings.predelay, settings.decay,
+        settings.diffusion, settings.hpCutoff, settings.lpCutoff);
+}
+
+void ReverbFreezer::run()
+{
+    juce::ScopedNoDenormals noDenormals;
+
+    while (!threadShouldExit())
+    {
+        // Someone's waiting on a capture, freezing can wait
+        {
+            Settings settings;
+            CaptureCallback callback;
+
+            {
+                const juce::ScopedLock sl(captureLock);
+                settings = captureSettings;
+                std::swap(callback, captureCallback);
+            }
+
+            if (callback != nullptr)
+            {
+                const juce::ScopedLock sl(renderLock);
+                juce::AudioBuffer<float> impulse;
+                renderImpulse(impulse, settings);
+                callback(impulse, sampleRate);
+                continue;
+            }
+        }
+
+        const auto count = numRequests.load(std::memory_order_acquire);
+
+        if (count == handledRequests)
+        {
+            wait(-1);
+            continue;
+        }
+
+        // Knobs that are still moving send another request before this is up.
+        // A notify left over from the last render just restarts the wait
+        if (wait(settleMs) || threadShouldExit() || numRequests.load(std::memory_order_acquire) != count)
+            continue;
+
+        const juce::ScopedLock sl(renderLock);
+        handledRequests = count;
+
+        const auto settings = fromFields(requested);
+        if (hasRendered && settings == rendered)
+            continue;
+
+        juce::AudioBuffer<float> impulse;
+        renderImpulse(impulse, settings);
+
+        // Invalid while the settings are rewritten
+        frozenVersion.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        const auto fields = toFields(settings);
+        for (int i = 0; i < numFields; ++i)
+            frozen[static_cast<size_t>(i)].store(fields[static_cast<size_t>(i)], std::memory_order_relaxed);
+
+        // At the FDN's own level, the two are swapped back and forth
+        const auto version = convolution.setImpulseResponse(impulse, sampleRate, false);
+        frozenVersion.store(version, std::memory_order_release);
+
+        rendered = settings;
+        hasRendered = true;
+    }
+}
+
+double ReverbFreezer::getImpulseSeconds(double sampleRate, double predelay, double decay) noexcept
+{
+    return juce::jmin(FDNReverb::getTailSeconds(sampleRate, predelay, decay), ConvolutionReverb::maxImpulseSeconds);
+}
+
+std::array<float, ReverbFreezer::numFields> ReverbFreezer::toFields(const Settings& settings) noexcept
+{
+    return { settings.predelay, settings.decay, settings.diffusion, settings.hpCutoff, settings.lpCutoff };
+}
+
+ReverbFreezer::Settings ReverbFreezer::fromFields(const std::array<std::atomic<float>, numFields>& fields) noexcept
+{
+    Settings settings;
+    settings.predelay = fields[0].load(std::memory_order_relaxed);
+    settings.decay = fields[1].load(std::memory_order_relaxed);
+    settings.diffusion = fields[2].load(std::memory_order_relaxed);
+    settings.hpCutoff = fields[3].load(std::memory_order_relaxed);
+    settings.lpCutoff = fields[4].load(std::memory_order_relaxed);
+    return settings;
+}
@@ -0,0 +1,103 @@
+/*
+  ==============================================================================
+
+    ReverbFreezer.h
+    Created: 26 Oct 2026 9:40:12am
+    Author:  mikey
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "ConvolutionReverb.h"
+#include "FDNReverb.h"
+
+// With its parameters held still, the FDN is (close to) a fixed linear system,
+// so its impulse response can stand in for it. The freezer renders one on a
+// worker thread for the settings the audio thread asks for, and plays it with
+// a ConvolutionReverb. The worker waits for the settings to settle first, so a
+// knob being turned doesn't start a render every block. The same worker
+// renders captures of the FDN for the convolution engine, off the message thread.
+class ReverbFreezer : private juce::Thread
+{
+public:
+    struct Settings
+    {
+        float predelay = 0.0f, decay = 0.0f, diffusion = 0.0f;
+        float hpCutoff = 0.0f, lpCutoff = 0.0f;
+
+        bool operator==(const Settings& other) const noexcept
+        {
+            return predelay == other.predelay && decay == other.decay && diffusion == other.diffusion
+                && hpCutoff == other.hpCutoff && lpCutoff == other.lpCutoff;
+        }
+
+        bool operator!=(const Settings& other) const noexcept { return !(*this == other); }
+    };
+
+    static constexpr int settleMs = 250;
+
+    // Long enough for the FDN's whole tail with these settings, within what a
+    // ConvolutionReverb takes
+    static double getImpulseSeconds(double sampleRate, double predelay, double decay) noexcept;
+
+    ReverbFreezer();
+    ~ReverbFreezer() override;
+
+    // From prepareToPlay. Anything frozen before is rendered again at the new rate
+    void prepare(double newSampleRate, int newNumChannels);
+
+    // Audio thread: the settings to freeze next. Only a change wakes the worker
+    void request(const Settings& settings) noexcept;
+
+    // Audio thread: whether the impulse response playing is these settings'
+    bool isFrozen(const Settings& settings) noexcept;
+
+    // Audio thread, same as ConvolutionReverb's
+    void reset() noexcept { convolution.reset(); }
+    void process(juce::AudioBuffer<float>& buffer, const float* dryWetPoints, int interval) noexcept { convolution.process(buffer, dryWetPoints, interval); }
+
+    void setNonRealtime(bool shouldWait) noexcept { convolution.setNonRealtime(shouldWait); }
+
+    // Any thread but the audio thread: renders the FDN for these settings on
+    // the worker (ahead of any freezing) and hands the impulse response, at the
+    // FDN's own level, to onRendered there. A capture still waiting is replaced
+    using CaptureCallback = std::function<void(const juce::AudioBuffer<float>& impulse, double sampleRate)>;
+    void capture(const Settings& settings, CaptureCallback onRendered);
+
+private:
+    void run() override;
+    void renderImpulse(juce::AudioBuffer<float>& impulse, const Settings& settings) const;
+
+    // Caller to worker: the one capture waiting, if any
+    juce::CriticalSection captureLock;
+    Settings captureSettings;
+    CaptureCallback captureCallback;
+
+    ConvolutionReverb convolution;
+
+    // Audio thread to worker: the latest request, and how many there have been
+    static constexpr int numFields = 5;
+    std::array<std::atomic<float>, numFields> requested{};
+    std::atomic<juce::uint32> numRequests{ 0 };
+    Settings lastRequest;
+    bool hasRequested = false;
+
+    // Worker to audio thread: what the version 'frozenVersion' of the convolution
+    // holds. frozenVersion is 0 while it's being rewritten
+    std::array<std::atomic<float>, numFields> frozen{};
+    std::atomic<juce::uint32> frozenVersion{ 0 };
+
+    // Worker, and prepare() under renderLock
+    juce::CriticalSection renderLock;
+    double sampleRate = 44100.0;
+    juce::uint32 handledRequests = 0;
+    Settings rendered;
+    bool hasRendered = false;
+
+    static std::array<float, numFields> toFields(const Settings& settings) noexcept;
+    static Settings fromFields(const std::array<std::atomic<float>, numFields>& fields) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ReverbFreezer)
+};
@@ -0,0 +1,541 @@
+/*
+  ==============================================================================
+
+    SamplePool.cpp
+    Created: 19 Oct 2026 2:15:48pm
+    Author:  mikey
+
+  ==============================================================================
+*/
+
+#include "SamplePool.h"
+#include "BinaryData.h"
+#include "Resampler.h"
+
+namespace
+{
+    // Bank layout: header, one entry per note slot, then 64-byte aligned float frames
+    constexpr char bankMagic[8] = { 'L', 'I', 'S', 'Z', 'T', 'B', 'N', 'K' };
+    // Bump when the layout or Resampler::Offline changes, it's part of the file names
+    constexpr juce::uint32 bankVersion = 1;
+
+    struct BankHeader
+    {
+        char magic[8];
+        juce::uint32 version;
+        juce::uint32 numEntries;
+        juce::uint64 dataOffset; // Bytes from the start of the file
+    };
+
+    struct BankEntry
+    {
+        juce::int32 midiNote;
+        juce::int32 reserved;
+        double sampleRate;
+        juce::int64 offset; // Frames from dataOffset
+        juce::int64 length; // 0 if the note didn't load
+    };
+
+    constexpr int numNoteSlots = SamplePool::numNoteSlots;
+
+    juce::String getResourceName(int midiNote)
+    {
+        return "_" + juce::String(midiNote) + "_wav";
+    }
+}
+
+//==============================================================================
+SamplePool::SamplePool()
+    : juce::Thread("Liszt sample loader")
+{
+    startThread(juce::Thread::Priority::normal);
+}
+
+SamplePool::~SamplePool()
+{
+    // Decoding and resampling check threadShouldExit() between notes
+    stopThread(10000);
+}
+
+void SamplePool::run()
+{
+    if (!loadNativeBank())
+        return;
+
+    while (!threadShouldExit())
+    {
+        double hostRate = 0.0;
+
+        {
+            const juce::ScopedLock sl(requestLock);
+
+            if (!requestedRates.isEmpty())
+                hostRate = requestedRates.removeAndReturn(0);
+        }
+
+        if (hostRate <= 0.0)
+        {
+            wait(-1);
+            continue;
+        }
+
+        if (findBank(hostRate) == nullptr && !isNativeRate(hostRate))
+            loadResampledBank(hostRate);
+    }
+}
+
+void SamplePool::requestSampleRate(double hostRate)
+{
+    if (hostRate <= 0.0 || findBank(hostRate) != nullptr)
+        return;
+
+    {
+        const juce::ScopedLock sl(requestLock);
+        requestedRates.addIfNotAlreadyThere(hostRate);
+    }
+
+    notify();
+}
+
+bool SamplePool::isReadyForSampleRate(double hostRate) const noexcept
+{
+    return isLoaded() && (isNativeRate(hostRate) || findBank(hostRate) != nullptr);
+}
+
+bool SamplePool::isMemoryMapped() const noexcept
+{
+    return isLoaded() && banks[0]->mapped != nullptr;
+}
+
+const SamplePool::Sample* SamplePool::getSample(int midiNote, double hostRate) const noexcept
+{
+    if (!isLoaded() || midiNote < lowestNote || midiNote > highestNote)
+        return nullptr;
+
+    const Bank* bank = hostRate > 0.0 ? findBank(hostRate) : nullptr;
+
+    if (bank == nullptr)
+        bank = banks[0].get();
+
+    auto& slot = bank->slots[static_cast<size_t>(midiNote - lowestNote)];
+    return slot.length > 0 ? &slot : nullptr;
+}
+
+const SamplePool::Bank* SamplePool::findBank(double hostRate) const noexcept
+{
+    const int count = numBanks.load(std::memory_order_acquire);
+
+    for (int i = 1; i < count; ++i)
+        if (banks[static_cast<size_t>(i)]->hostRate == hostRate)
+            return banks[static_cast<size_t>(i)].get();
+
+    return nullptr;
+}
+
+bool SamplePool::isNativeRate(double hostRate) const noexcept
+{
+    if (!isLoaded())
+        return false;
+
+    for (auto& slot : banks[0]->slots)
+        if (slot.length > 0 && slot.sampleRate != hostRate)
+            return false;
+
+    return true;
+}
+
+void SamplePool::publish(std::unique_ptr<Bank> bank)
+{
+    // Only this thread adds banks, and readers never look past numBanks
+    const int index = numBanks.load(std::memory_order_relaxed);
+    banks[static_cast<size_t>(index)] = std::move(bank);
+    numBanks.store(index + 1, std::memory_order_release);
+}
+
+//==============================================================================
+bool SamplePool::loadNativeBank()
+{
+    bankHash = [&]
+    {
+        // Keyed on the embedded resources, so a build with different samples gets its own banks
+        juce::uint64 hash = 14695981039346656037ull;
+        const auto addToHash = [&hash](const void* data, size_t numBytes)
+        {
+            for (size_t i = 0; i < numBytes; ++i)
+                hash = (hash ^ static_cast<const juce::uint8*>(data)[i]) * 1099511628211ull;
+        };
+
+        addToHash(&bankVersion, sizeof(bankVersion));
+
+        for (int midiNote = lowestNote; midiNote <= highestNote; ++midiNote)
+        {
+            int size = 0;
+            if (auto* data = BinaryData::getNamedResource(getResourceName(midiNote).toRawUTF8(), size))
+            {
+                const auto numBytes = static_cast<size_t>(size);
+                const auto edge = juce::jmin(numBytes, static_cast<size_t>(4096));
+
+                addToHash(&midiNote, sizeof(midiNote));
+                addToHash(&size, sizeof(size));
+                addToHash(data, edge);
+                addToHash(static_cast<const char*>(data) + numBytes - edge, edge);
+            }
+        }
+
+        return juce::String::toHexString(static_cast<juce::int64>(hash));
+    }();
+
+    auto bank = std::make_unique<Bank>();
+
+    if (!loadBank(*bank, getBankFile(0.0), [this](const SampleCallback& callback) { return decodeResources(callback); }))
+        return false;
+
+    progress.store(1.0f, std::memory_order_relaxed);
+    publish(std::move(bank));
+    deleteUnusedBankFiles();
+    return true;
+}
+
+bool SamplePool::loadResampledBank(double hostRate)
+{
+    if (numBanks.load(std::memory_order_relaxed) >= maxBanks)
+    {
+        DBG("No room for a sample bank at " << hostRate << " Hz, voices will resample");
+        return false;
+    }
+
+    auto bank = std::make_unique<Bank>();
+    bank->hostRate = hostRate;
+
+    const auto file = getBankFile(hostRate);
+
+    if (!loadBank(*bank, file, [this, hostRate](const SampleCallback& callback) { return resampleNativeBank(hostRate, callback); }))
+        return false;
+
+    publish(std::move(bank));
+
+    // The modification time orders the rates by when they were last used
+    file.setLastModificationTime(juce::Time::getCurrentTime());
+    deleteUnusedBankFiles();
+    return true;
+}
+
+bool SamplePool::loadBank(Bank& bank, const juce::File& file, const SampleSource& source)
+{
+    for (int i = 0; i < numNoteSlots; ++i)
+        bank.slots[static_cast<size_t>(i)].midiNote = lowestNote + i;
+
+    if (!mapBank(file, bank))
+    {
+        if (threadShouldExit())
+            return false;
+
+        if (!writeBank(file, source) || !mapBank(file, bank))
+        {
+            if (threadShouldExit())
+                return false;
+
+            DBG("Couldn't use sample bank " << file.getFullPathName() << ", keeping it in memory");
+
+            if (!fillInMemory(bank, source))
+                return false;
+        }
+    }
+
+    copyPreloads(bank);
+    return true;
+}
+
+juce::File SamplePool::getBankFile(double hostRate) const
+{
+    auto name = "SampleBank-" + bankHash;
+
+    if (hostRate > 0.0)
+        name << "-" << juce::String(juce::roundToInt(hostRate)) << "Hz";
+
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+        .getChildFile("Liszt")
+        .getChildFile(name + ".bin");
+}
+
+void SamplePool::deleteUnusedBankFiles()
+{
+    const auto folder = getBankFile(0.0).getParentDirectory();
+    const auto currentPrefix = "SampleBank-" + bankHash;
+    const auto now = juce::Time::getCurrentTime();
+
+    juce::Array<juce::File> resampled;
+
+    for (const auto& entry : juce::RangedDirectoryIterator(folder, false, "SampleBank-*", juce::File::findFiles))
+    {
+        const auto& file = entry.getFile();
+        const auto name = file.getFileNameWithoutExtension();
+
+        if (name.startsWith(currentPrefix + "-") && name.endsWith("Hz"))
+        {
+            resampled.add(file);
+            continue;
+        }
+
+        // Another build's samples, or what's left of a write that never finished.
+        // Anything that recent may still be being written by another process
+        if (!name.startsWith(currentPrefix) || name.contains("temp"))
+            if (now - entry.getModificationTime() > juce::RelativeTime::minutes(10))
+                file.deleteFile();
+    }
+
+    // Newest first, the rates this process has loaded are kept whatever their age
+    std::sort(resampled.begin(), resampled.end(), [](const juce::File& a, const juce::File& b)
+    {
+        return a.getLastModificationTime() > b.getLastModificationTime();
+    });
+
+    int numKept = 0;
+
+    for (const auto& file : resampled)
+    {
+        bool inUse = false;
+        for (int i = 1; i < numBanks.load(std::memory_order_acquire); ++i)
+            inUse = inUse || getBankFile(banks[static_cast<size_t>(i)]->hostRate) == file;
+
+        if (inUse || numKept < maxCachedRates)
+            ++numKept;
+        else
+            file.deleteFile();
+    }
+}
+
+bool SamplePool::decodeResources(const SampleCallback& callback)
+{
+    juce::AudioFormatManager formatManager;
+    formatManager.registerFormat(new juce::WavAudioFormat(), true);
+
+    juce::AudioBuffer<float> scratch;
+    std::vector<float> mono;
+
+    for (int midiNote = lowestNote; midiNote <= highestNote; ++midiNote)
+    {
+        if (threadShouldExit())
+            return false;
+
+        progress.store(static_cast<float>(midiNote - lowestNote) / static_cast<float>(numNoteSlots), std::memory_order_relaxed);
+
+        const auto fileName = getResourceName(midiNote);
+        int size = 0;
+
+        auto* data = BinaryData::getNamedResource(fileName.toRawUTF8(), size);
+        if (data == nullptr)
+        {
+            DBG("Failed to load sample data for " << fileName);
+            continue;
+        }
+
+        auto inputStream = std::make_unique<juce::MemoryInputStream>(data, static_cast<size_t>(size), false);
+        std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(std::move(inputStream)));
+
+        if (reader == nullptr)
+        {
+            DBG("Failed to create AudioFormatReader for " << fileName);
+            continue;
+        }
+
+        const double sampleRate = reader->sampleRate > 0.0 ? reader->sampleRate : 44100.0;
+        const auto length = static_cast<int>(juce::jmin(reader->lengthInSamples,
+                                                        static_cast<juce::int64>(maxSampleLengthSeconds * sampleRate)));
+        const int numChannels = juce::jmax(1, static_cast<int>(reader->numChannels));
+
+        scratch.setSize(numChannels, length, false, false, true);
+        reader->read(&scratch, 0, length, 0, true, true);
+
+        // Voices only ever play the average of the channels
+        mono.assign(scratch.getReadPointer(0), scratch.getReadPointer(0) + length);
+
+        for (int channel = 1; channel < numChannels; ++channel)
+            juce::FloatVectorOperations::add(mono.data(), scratch.getReadPointer(channel), length);
+
+        if (numChannels > 1)
+            juce::FloatVectorOperations::multiply(mono.data(), 1.0f / static_cast<float>(numChannels), length);
+
+        callback(midiNote, sampleRate, mono.data(), length);
+    }
+
+    return true;
+}
+
+bool SamplePool::resampleNativeBank(double hostRate, const SampleCallback& callback)
+{
+    std::optional<Resampler::Offline> resampler;
+    std::vector<float> resampled;
+
+    for (auto& slot : banks[0]->slots)
+    {
+        if (threadShouldExit())
+            return false;
+
+        if (slot.length <= 0)
+            continue;
+
+        // The kernel only depends on the ratio, and every note is normally at the same rate
+        const double step = slot.sampleRate / hostRate;
+
+        if (!resampler.has_value() || resampler->getStep() != step)
+            resampler.emplace(step);
+
+        const auto length = resampler->getOutputLength(slot.length);
+        resampled.resize(static_cast<size_t>(length));
+        resampler->process(slot.frames, slot.length, resampled.data(), length);
+
+        callback(slot.midiNote, hostRate, resampled.data(), static_cast<int>(length));
+    }
+
+    return true;
+}
+
+bool SamplePool::writeBank(const juce::File& file, const SampleSource& source)
+{
+    if (!file.getParentDirectory().createDirectory())
+        return false;
+
+    // Written next to the real name and moved into place, so another instance (or
+    // process) never maps a half-written bank
+    const juce::TemporaryFile temporary(file);
+
+    {
+        juce::FileOutputStream stream(temporary.getFile());
+        if (!stream.openedOk())
+            return false;
+
+        BankHeader header{};
+        std::copy(std::begin(bankMagic), std::end(bankMagic), header.magic);
+        header.version = bankVersion;
+        header.numEntries = static_cast<juce::uint32>(numNoteSlots);
+        header.dataOffset = (sizeof(BankHeader) + sizeof(BankEntry) * numNoteSlots + 63) & ~static_cast<juce::uint64>(63);
+
+        std::vector<BankEntry> entries(static_cast<size_t>(numNoteSlots));
+        for (int i = 0; i < numNoteSlots; ++i)
+            entries[static_cast<size_t>(i)] = { lowestNote + i, 0, 44100.0, 0, 0 };
+
+        // Frames go first, the table is filled in once we know where they landed
+        stream.setPosition(static_cast<juce::int64>(header.dataOffset));
+        juce::int64 nextOffset = 0;
+        bool ok = true;
+
+        const bool finished = source([&](int midiNote, double sampleRate, const float* frames, int length)
+        {
+            auto& entry = entries[static_cast<size_t>(midiNote - lowestNote)];
+            entry.sampleRate = sampleRate;
+            entry.offset = nextOffset;
+            entry.length = length;
+
+            ok = ok && stream.write(frames, sizeof(float) * static_cast<size_t>(length));
+            nextOffset += length;
+        });
+
+        ok = ok
+            && finished
+            && stream.setPosition(0)
+            && stream.write(&header, sizeof(header))
+            && stream.write(entries.data(), sizeof(BankEntry) * entries.size());
+
+        stream.flush();
+
+        if (!ok || stream.getStatus().failed())
+            return false;
+    }
+
+    return temporary.overwriteTargetFileWithTemporary();
+}
+
+bool SamplePool::mapBank(const juce::File& file, Bank& bank)
+{
+    if (!file.existsAsFile())
+        return false;
+
+    auto mapped = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readOnly);
+    const auto* base = static_cast<const char*>(mapped->getData());
+    const auto size = static_cast<juce::uint64>(mapped->getSize());
+
+    if (base == nullptr || size < sizeof(BankHeader))
+        return false;
+
+    BankHeader header;
+    std::memcpy(&header, base, sizeof(header));
+
+    if (!std::equal(std::begin(bankMagic), std::end(bankMagic), header.magic)
+        || header.version != bankVersion
+        || header.numEntries != static_cast<juce::uint32>(numNoteSlots)
+        || header.dataOffset % 64 != 0
+        || header.dataOffset < sizeof(BankHeader) + sizeof(BankEntry) * numNoteSlots
+        || header.dataOffset > size)
+        return false;
+
+    const auto numDataFrames = static_cast<juce::int64>((size - header.dataOffset) / sizeof(float));
+    const auto* frames = reinterpret_cast<const float*>(base + header.dataOffset);
+
+    std::array<Sample, numNoteSlots> mappedSlots = bank.slots;
+
+    for (int i = 0; i < numNoteSlots; ++i)
+    {
+        BankEntry entry;
+        std::memcpy(&entry, base + sizeof(BankHeader) + sizeof(BankEntry) * static_cast<size_t>(i), sizeof(entry));
+
+        if (entry.length <= 0)
+            continue;
+
+        // A resampled bank's file name only has the rate to the nearest Hz
+        if (entry.midiNote != lowestNote + i || entry.offset < 0
+            || entry.offset + entry.length > numDataFrames || entry.sampleRate <= 0.0
+            || (bank.hostRate > 0.0 && entry.sampleRate != bank.hostRate))
+            return false;
+
+        auto& slot = mappedSlots[static_cast<size_t>(i)];
+        slot.sampleRate = entry.sampleRate;
+        slot.frames = frames + entry.offset;
+        slot.length = entry.length;
+    }
+
+    bank.slots = mappedSlots;
+    bank.mapped = std::move(mapped);
+    return true;
+}
+
+bool SamplePool::fillInMemory(Bank& bank, const SampleSource& source)
+{
+    std::array<juce::int64, numNoteSlots> offsets{};
+
+    const bool finished = source([&bank, &offsets](int midiNote, double sampleRate, const float* frames, int length)
+    {
+        auto& slot = bank.slots[static_cast<size_t>(midiNote - lowestNote)];
+        slot.sampleRate = sampleRate;
+        slot.length = length;
+
+        offsets[static_cast<size_t>(midiNote - lowestNote)] = static_cast<juce::int64>(bank.frames.size());
+        bank.frames.insert(bank.frames.end(), frames, frames + length);
+    });
+
+    // Pointers only once the vector has stopped growing
+    for (size_t i = 0; i < bank.slots.size(); ++i)
+        if (bank.slots[i].length > 0)
+            bank.slots[i].frames = bank.frames.data() + offsets[i];
+
+    return finished;
+}
+
+void SamplePool::copyPreloads(Bank& bank)
+{
+    size_t total = 0;
+    for (auto& sample : bank.slots)
+        total += static_cast<size_t>(juce::jmin(sample.length, static_cast<juce::int64>(preloadLength)));
+
+    bank.preloads.resize(total);
+    auto* destination = bank.preloads.data();
+
+    for (auto& sample : bank.slots)
+    {
+        sample.preloadLength = static_cast<int>(juce::jmin(sample.length, static_cast<juce::int64>(preloadLength)));
+        sample.preload = destination;
+
+        std::copy_n(sample.frames, sample.preloadLength, destination);
+        destination += sample.preloadLength;
+    }
+}
@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    SamplePool.h
+    Created: 19 Oct 2026 2:15:48pm
+    Author:  mikey
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+//==============================================================================
+// The decoded piano, shared read-only by every plugin instance in the process.
+// Use it through juce::SharedResourcePointer<SamplePool>.
+//
+// The first instance decodes the BinaryData WAVs once into a packed bank file
+// (mono float frames) in the user's app data folder. After that, every instance
+// and every later session memory-maps that file, so the audio lives in the OS
+// page cache once rather than once per instance. Only the attack preloads are
+// copied into RAM, and those are shared too.
+//
+// Hosts that don't run at the samples' own rate can ask for a copy of the bank
+// resampled offline to theirs (requestSampleRate()). It's built the same way,
+// cached next to the original as its own file, and once it's in, voices play it
+// 1:1 and only resample for pitch bend. Only the last few rates used stay on
+// disk, and files from builds with other samples are deleted.
+//
+// All of that happens on the pool's own thread. Until isLoaded() the slots are
+// empty, and the audio thread can check that without locking.
+class SamplePool : private juce::Thread
+{
+public:
+    SamplePool();
+    ~SamplePool() override;
+
+    struct Sample
+    {
+        int midiNote = 0;
+        double sampleRate = 44100.0;
+        const float* frames = nullptr;   // Whole sample, mapped
+        const float* preload = nullptr;  // First preloadLength frames, always in RAM
+        juce::int64 length = 0;
+        int preloadLength = 0;
+    };
+
+    // Any thread. Once true it stays true, and every native slot is final
+    bool isLoaded() const noexcept { return numBanks.load(std::memory_order_acquire) > 0; }
+
+    // 0 to 1, for the UI
+    float getLoadingProgress() const noexcept { return progress.load(std::memory_order_relaxed); }
+
+    // Loaded sample for a note, or nullptr. With a host rate, the copy resampled
+    // to that rate if it's been built, otherwise the native one. Audio thread safe,
+    // and the Sample stays valid for the pool's lifetime
+    const Sample* getSample(int midiNote, double hostRate = 0.0) const noexcept;
+
+    // Any thread. Queues a resampled copy of the bank for hostRate, unless the
+    // samples are already at that rate or it's been built before
+    void requestSampleRate(double hostRate);
+
+    // True once getSample() for hostRate plays without converting rates
+    bool isReadyForSampleRate(double hostRate) const noexcept;
+
+    bool isMemoryMapped() const noexcept;
+
+    static constexpr int lowestNote = 24;
+    static constexpr int highestNote = 101;
+    static constexpr double maxSampleLengthSeconds = 10.0;
+    static constexpr int preloadLength = 16384;
+    static constexpr int numNoteSlots = highestNote - lowestNote + 1;
+
+    // Native plus this many host rates, a session rarely sees more than two
+    static constexpr int maxBanks = 8;
+
+    // Resampled bank files kept on disk, the most recently used ones
+    static constexpr int maxCachedRates = 3;
+
+private:
+    // One complete set of slots, at the samples' own rate or one host's
+    struct Bank
+    {
+        double hostRate = 0.0; // 0 for the native bank
+        std::unique_ptr<juce::MemoryMappedFile> mapped;
+        std::vector<float> frames; // Only when the bank file can't be used
+        std::vector<float> preloads;
+        std::array<Sample, numNoteSlots> slots;
+    };
+
+    using SampleCallback = std::function<void(int midiNote, double sampleRate, const float* frames, int length)>;
+
+    // Hands every sample of a bank to the callback. Returns false if the thread
+    // was asked to stop part way
+    using SampleSource = std::function<bool(const SampleCallback&)>;
+
+    void run() override;
+
+    bool loadBank(Bank& bank, const juce::File& file, const SampleSource& source);
+    bool loadNativeBank();
+    bool loadResampledBank(double hostRate);
+    void publish(std::unique_ptr<Bank> bank);
+    const Bank* findBank(double hostRate) const noexcept;
+    bool isNativeRate(double hostRate) const noexcept;
+
+    juce::File getBankFile(double hostRate) const;
+    void deleteUnusedBankFiles();
+    bool writeBank(const juce::File& file, const SampleSource& source);
+    bool mapBank(const juce::File& file, Bank& bank);
+    bool fillInMemory(Bank& bank, const SampleSource& source);
+    void copyPreloads(Bank& bank);
+
+    // Decodes every resource as a mono mixdown
+    bool decodeResources(const SampleCallback& callback);
+
+    // Runs the native bank through Resampler::Offline
+    bool resampleNativeBank(double hostRate, const SampleCallback& callback);
+
+    // Written once by the loader thread, then read by anyone up to numBanks
+    std::array<std::unique_ptr<Bank>, maxBanks> banks;
+    std::atomic<int> numBanks{ 0 };
+    std::atomic<float> progress{ 0.0f };
+
+    juce::String bankHash;
+
+    juce::CriticalSection requestLock;
+    juce::Array<double> requestedRates;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SamplePool)
+};
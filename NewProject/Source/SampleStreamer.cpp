@@ -0,0 +1,134 @@
+/*
+  ==============================================================================
+
+    SampleStreamer.cpp
+    Created: 19 Oct 2026 9:40:12am
+    Author:  mikey
+
+  ==============================================================================
+*/
+
+#include "SampleStreamer.h"
+
+//==============================================================================
+StreamingSamplerSound::StreamingSamplerSound(const juce::String& soundName, const SamplePool& samplePool, int midiNote)
+    : name(soundName),
+      rootNote(midiNote),
+      pool(samplePool)
+{
+}
+
+//==============================================================================
+VoiceStream::VoiceStream(SampleStreamer& streamer)
+    : owner(streamer),
+      ring(static_cast<size_t>(ringSize), 0.0f)
+{
+    owner.getThread().addTimeSliceClient(this);
+}
+
+VoiceStream::~VoiceStream()
+{
+    owner.getThread().removeTimeSliceClient(this);
+}
+
+void VoiceStream::start(const SamplePool::Sample* sample, juce::int64 startFrame) noexcept
+{
+    requestedSample.store(sample, std::memory_order_relaxed);
+    requestedStartFrame.store(startFrame, std::memory_order_relaxed);
+    requestGeneration.fetch_add(1, std::memory_order_release);
+}
+
+void VoiceStream::stop() noexcept
+{
+    if (requestedSample.load(std::memory_order_relaxed) == nullptr)
+        return;
+
+    start(nullptr, 0);
+}
+
+bool VoiceStream::isServingRequest() const noexcept
+{
+    return servedGeneration.load(std::memory_order_acquire) == requestGeneration.load(std::memory_order_relaxed);
+}
+
+int VoiceStream::read(float* destination, int numFrames) noexcept
+{
+    if (!isServingRequest())
+        return 0;
+
+    const auto scope = fifo.read(juce::jmin(numFrames, fifo.getNumReady()));
+
+    if (scope.blockSize1 > 0)
+        std::copy_n(ring.data() + scope.startIndex1, scope.blockSize1, destination);
+
+    if (scope.blockSize2 > 0)
+        std::copy_n(ring.data() + scope.startIndex2, scope.blockSize2, destination + scope.blockSize1);
+
+    return scope.blockSize1 + scope.blockSize2;
+}
+
+int VoiceStream::skip(int numFrames) noexcept
+{
+    if (!isServingRequest())
+        return 0;
+
+    const int numSkipped = juce::jmin(numFrames, fifo.getNumReady());
+    fifo.finishedRead(numSkipped);
+    return numSkipped;
+}
+
+int VoiceStream::useTimeSlice()
+{
+    const int generation = requestGeneration.load(std::memory_order_acquire);
+
+    if (generation != lastGeneration)
+    {
+        // New note or stop: the audio thread won't touch the ring until we publish
+        // the generation below, so it's safe to restart it from here
+        fifo.reset();
+        currentSample = requestedSample.load(std::memory_order_relaxed);
+        nextFrame = requestedStartFrame.load(std::memory_order_relaxed);
+
+        lastGeneration = generation;
+        servedGeneration.store(generation, std::memory_order_release);
+    }
+
+    if (currentSample == nullptr)
+        return 5;
+
+    const int numToRead = static_cast<int>(juce::jmin(static_cast<juce::int64>(fifo.getFreeSpace()),
+                                                      currentSample->length - nextFrame,
+                                                      static_cast<juce::int64>(4096)));
+
+    // Ring is full (or the sound is done), check back shortly
+    if (numToRead <= 0)
+        return 2;
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(numToRead, start1, size1, start2, size2);
+
+    // Any page faults on the mapped bank happen here rather than on the audio thread
+    const auto* source = currentSample->frames + nextFrame;
+
+    if (size1 > 0)
+        std::copy_n(source, size1, ring.data() + start1);
+
+    if (size2 > 0)
+        std::copy_n(source + size1, size2, ring.data() + start2);
+
+    fifo.finishedWrite(size1 + size2);
+    nextFrame += size1 + size2;
+
+    return 0;
+}
+
+//==============================================================================
+SampleStreamer::SampleStreamer()
+{
+    thread.startThread(juce::Thread::Priority::high);
+}
+
+SampleStreamer::~SampleStreamer()
+{
+    thread.stopThread(1000);
+}
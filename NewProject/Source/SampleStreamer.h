@@ -0,0 +1,122 @@
+/*
+  ==============================================================================
+
+    SampleStreamer.h
+    Created: 19 Oct 2026 9:40:12am
+    Author:  mikey
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+#include "SamplePool.h"
+
+class SampleStreamer;
+
+//==============================================================================
+// One piano note, pointing into the shared SamplePool. Only the attack (the
+// preload) is read by the audio thread directly, the rest goes through the
+// voice's stream so the audio thread never touches mapped pages.
+// Until the pool has loaded the sound applies to no notes, so nothing plays.
+class StreamingSamplerSound : public juce::SynthesiserSound
+{
+public:
+    using Ptr = juce::ReferenceCountedObjectPtr<StreamingSamplerSound>;
+
+    StreamingSamplerSound(const juce::String& soundName, const SamplePool& pool, int midiNote);
+
+    bool appliesToNote(int midiNoteNumber) override { return midiNoteNumber == rootNote && isReady(); }
+    bool appliesToChannel(int) override { return true; }
+
+    bool isReady() const noexcept { return pool.getSample(rootNote) != nullptr; }
+
+    const juce::String& getName() const noexcept { return name; }
+    int getMidiNote() const noexcept { return rootNote; }
+
+    // What a voice at hostRate should play: the pool's copy at that rate if it
+    // has one, the native sample if not. nullptr until isReady()
+    const SamplePool::Sample* getSample(double hostRate) const noexcept { return pool.getSample(rootNote, hostRate); }
+
+private:
+    juce::String name;
+    int rootNote = 60;
+    const SamplePool& pool;
+
+    JUCE_LEAK_DETECTOR(StreamingSamplerSound)
+};
+
+//==============================================================================
+// Per-voice stream: a single-producer / single-consumer ring of mono frames that
+// the streaming thread keeps topped up from the current sample's mapped frames.
+// The audio thread only ever calls start(), stop(), read() and skip().
+class VoiceStream : public juce::TimeSliceClient
+{
+public:
+    explicit VoiceStream(SampleStreamer& owner);
+    ~VoiceStream() override;
+
+    // Audio thread: streams 'sample' starting at startFrame (usually the end of its preload)
+    void start(const SamplePool::Sample* sample, juce::int64 startFrame) noexcept;
+    void stop() noexcept;
+
+    // Audio thread: copies up to numFrames, returns how many were ready
+    int read(float* destination, int numFrames) noexcept;
+
+    // Audio thread: drops up to numFrames, returns how many were dropped
+    int skip(int numFrames) noexcept;
+
+    SampleStreamer& getOwner() noexcept { return owner; }
+
+    int useTimeSlice() override;
+
+    static constexpr int ringSize = 32768;
+
+private:
+    bool isServingRequest() const noexcept;
+
+    SampleStreamer& owner;
+
+    juce::AbstractFifo fifo{ ringSize };
+    std::vector<float> ring;
+
+    // Written by the audio thread, picked up by the streaming thread. The audio
+    // thread won't read until servedGeneration has caught up with requestGeneration
+    std::atomic<const SamplePool::Sample*> requestedSample{ nullptr };
+    std::atomic<juce::int64> requestedStartFrame{ 0 };
+    std::atomic<int> requestGeneration{ 0 };
+    std::atomic<int> servedGeneration{ 0 };
+
+    // Streaming thread only
+    int lastGeneration = 0;
+    const SamplePool::Sample* currentSample = nullptr; // Lives as long as the pool
+    juce::int64 nextFrame = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VoiceStream)
+};
+
+//==============================================================================
+// Owns the background thread that feeds every VoiceStream
+class SampleStreamer
+{
+public:
+    SampleStreamer();
+    ~SampleStreamer();
+
+    juce::TimeSliceThread& getThread() noexcept { return thread; }
+
+    // Frames a voice had to replace with silence because its ring ran dry
+    void reportUnderrun(int numFrames) noexcept { underrunFrames.fetch_add(numFrames, std::memory_order_relaxed); }
+    int getNumUnderrunFrames() const noexcept { return underrunFrames.load(std::memory_order_relaxed); }
+
+    // Offline rendering: voices wait for their stream instead of playing silence
+    void setNonRealtime(bool shouldWait) noexcept { nonRealtime.store(shouldWait, std::memory_order_relaxed); }
+    bool isNonRealtime() const noexcept { return nonRealtime.load(std::memory_order_relaxed); }
+
+private:
+    juce::TimeSliceThread thread{ "Liszt sample streamer" };
+    std::atomic<int> underrunFrames{ 0 };
+    std::atomic<bool> nonRealtime{ false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SampleStreamer)
+};
@@ -0,0 +1,63 @@
+/*
+  ==============================================================================
+
+    ScopeFifo.cpp
+    Created: 18 Oct 2026 3:21:40pm
+    Author:  mikey
+
+  ==============================================================================
+*/
+
+#include "ScopeFifo.h"
+
+ScopeFifo::ScopeFifo(int capacity)
+    : fifo(capacity), buffer(static_cast<size_t>(capacity), 0.0f)
+{
+}
+
+void ScopeFifo::push(const float* samples, int numSamples, float gain) noexcept
+{
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+
+    if (size1 > 0)
+        juce::FloatVectorOperations::copyWithMultiply(buffer.data() + start1, samples, gain, size1);
+
+    if (size2 > 0)
+        juce::FloatVectorOperations::copyWithMultiply(buffer.data() + start2, samples + size1, gain, size2);
+
+    fifo.finishedWrite(size1 + size2);
+}
+
+int ScopeFifo::pull(float* destination, int maxOutputSamples, int decimation) noexcept
+{
+    decimation = juce::jmax(1, decimation);
+    const int maxToRead = maxOutputSamples * decimation;
+
+    int start1, size1, start2, size2;
+
+    // Skip whatever is too old to fit
+    const int numReady = fifo.getNumReady();
+    if (numReady > maxToRead)
+    {
+        fifo.prepareToRead(numReady - maxToRead, start1, size1, start2, size2);
+        fifo.finishedRead(size1 + size2);
+    }
+
+    fifo.prepareToRead(juce::jmin(maxToRead, fifo.getNumReady()), start1, size1, start2, size2);
+
+    int numWritten = 0;
+
+    for (auto [start, size] : { std::make_pair(start1, size1), std::make_pair(start2, size2) })
+    {
+        int index = (decimation - decimationPhase) % decimation;
+
+        for (; index < size && numWritten < maxOutputSamples; index += decimation)
+            destination[numWritten++] = buffer[static_cast<size_t>(start + index)];
+
+        decimationPhase = (decimationPhase + size) % decimation;
+    }
+
+    fifo.finishedRead(size1 + size2);
+    return numWritten;
+}
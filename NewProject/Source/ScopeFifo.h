@@ -0,0 +1,38 @@
+/*
+  ==============================================================================
+
+    ScopeFifo.h
+    Created: 18 Oct 2026 3:21:40pm
+    Author:  mikey
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+// Single-producer / single-consumer sample FIFO feeding the oscilloscope.
+// The audio thread pushes whole blocks with a vectorised copy, the GUI thread
+// pulls a bounded, decimated chunk of the most recent samples.
+class ScopeFifo
+{
+public:
+    explicit ScopeFifo(int capacity = 48000);
+
+    // Audio thread: copies the block scaled by gain, whatever doesn't fit is dropped
+    void push(const float* samples, int numSamples, float gain) noexcept;
+
+    // GUI thread: writes at most maxOutputSamples into destination, keeping one of every
+    // 'decimation' samples. Older samples that wouldn't fit are skipped so the scope
+    // always shows the latest audio. Returns the number of samples written
+    int pull(float* destination, int maxOutputSamples, int decimation) noexcept;
+
+private:
+    juce::AbstractFifo fifo;
+    std::vector<float> buffer;
+
+    // Keeps the decimation grid continuous across pulls (GUI thread only)
+    int decimationPhase = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ScopeFifo)
+};
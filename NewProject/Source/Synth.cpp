@@ -14,16 +14,170 @@
 Synth::Synth()
 {
 	formatManager.registerFormat(new juce::WavAudioFormat(), true);
-    for (int i = 0; i < 24; ++i) {
-        addVoice(new CustomSamplerVoice());
+    Resampler::prepareTables();
+
+    for (int i = 0; i < maxVoices; ++i) {
+        addVoice(new CustomSamplerVoice(streamer, allocator, i));
+    }
+
+    allocator.setNumVoices(defaultNumVoices);
+    setCullThreshold(defaultCullThreshold);
+
+    // Split the block exactly at every MIDI event rather than JUCE's default of
+    // 32-sample steps. The voices render in their own chunks either way
+    setMinimumRenderingSubdivisionSize(1, true);
+}
+
+Synth::~Synth()
+{
+    // The voices' streams are registered with the streamer, which goes before the base class
+    clearVoices();
+}
+
+void Synth::noteOn(int midiChannel, int midiNoteNumber, float velocity)
+{
+    const juce::ScopedLock sl(lock);
+
+    if (!juce::isPositiveAndBelow(midiNoteNumber, 128))
+        return;
+
+    auto* sound = soundForNote[static_cast<size_t>(midiNoteNumber)];
+
+    if (sound == nullptr || !sound->appliesToNote(midiNoteNumber) || !sound->appliesToChannel(midiChannel))
+        return;
+
+    // Still sounding (held, or kept by the sustain pedal), let it ring out
+    // under the new note like juce::Synthesiser does
+    if (const int held = allocator.getHeldVoiceForNote(midiNoteNumber); held >= 0)
+        stopVoice(voices[held], 1.0f, true);
+
+    int index = allocator.findFreeVoice();
+
+    if (index < 0 && isNoteStealingEnabled())
+        index = allocator.findVoiceToSteal(midiNoteNumber);
+
+    if (index >= 0)
+        startVoice(voices[index], sound, midiChannel, midiNoteNumber, velocity);
+}
+
+void Synth::addSoundForNote(int midiNote, juce::SynthesiserSound* sound)
+{
+    const juce::ScopedLock sl(lock);
+    soundForNote[static_cast<size_t>(midiNote)] = addSound(sound);
+}
+
+void Synth::setNumVoices(int numVoices)
+{
+    if (numVoices == allocator.getNumVoices())
+        return;
+
+    const juce::ScopedLock sl(lock);
+    allocator.setNumVoices(numVoices);
+
+    // Anything still playing above the new limit goes, but not with a click
+    for (int i = allocator.getNumVoices(); i < maxVoices; ++i)
+        if (allocator.isActive(i))
+            if (auto* samplerVoice = dynamic_cast<CustomSamplerVoice*>(voices[i]))
+            {
+                samplerVoice->fadeOut();
+                allocator.setDropping(i);
+            }
+}
+
+void Synth::enforceCpuBudget(double load)
+{
+    if (cpuBudget <= 0.0 || load <= cpuBudget)
+        return;
+
+    const juce::ScopedLock sl(lock);
+
+    // One voice at a time, and not until the last one has faded out, so this
+    // block's load is what that drop bought
+    if (lastDroppedVoice >= 0 && allocator.isDropping(lastDroppedVoice))
+        return;
+
+    const int index = allocator.findQuietestVoice();
+
+    if (index < 0)
+        return;
+
+    if (auto* samplerVoice = dynamic_cast<CustomSamplerVoice*>(voices[index]))
+    {
+        samplerVoice->fadeOut();
+        allocator.setDropping(index);
+        voicesDropped.fetch_add(1, std::memory_order_relaxed);
+        lastDroppedVoice = index;
     }
 }
 
-void Synth::loadSamples()
+void Synth::setPitchBend(float semitones)
+{
+    if (semitones == pitchBend)
+        return;
+
+    pitchBend = semitones;
+
+    for (auto* voice : voices)
+        if (auto* samplerVoice = dynamic_cast<CustomSamplerVoice*>(voice))
+            samplerVoice->setPitchBend(semitones);
+}
+
+void Synth::setResamplerQuality(Resampler::Quality quality)
+{
+    if (quality == resamplerQuality)
+        return;
+
+    resamplerQuality = quality;
+
+    for (auto* voice : voices)
+        if (auto* samplerVoice = dynamic_cast<CustomSamplerVoice*>(voice))
+            samplerVoice->setResamplerQuality(quality);
+}
+
+void Synth::setCurrentPlaybackSampleRate(double newRate)
 {
-    clearSounds();
+    juce::Synthesiser::setCurrentPlaybackSampleRate(newRate);
+
+    // Notes keep playing the native bank (converting as they go) until it's ready
+    if (sampleMode == SampleMode::streaming)
+        samplePool->requestSampleRate(newRate);
+}
+
+void Synth::setCullThreshold(float decibels)
+{
+    if (decibels == cullThreshold)
+        return;
+
+    cullThreshold = decibels;
+    const float gain = juce::Decibels::decibelsToGain(decibels, cullOff);
+
+    for (auto* voice : voices)
+        if (auto* samplerVoice = dynamic_cast<CustomSamplerVoice*>(voice))
+            samplerVoice->setCullThreshold(gain);
+}
+
+void Synth::loadSamples(SampleMode mode)
+{
+    {
+        const juce::ScopedLock sl(lock);
+        soundForNote.fill(nullptr);
+        clearSounds();
+    }
+
+    sampleMode = mode;
+
+    if (mode == SampleMode::streaming)
+    {
+        // The pool decodes (once per process, in the background), these just point
+        // into it and start applying to their notes once it's loaded
+        for (int midiNote = SamplePool::lowestNote; midiNote <= SamplePool::highestNote; ++midiNote)
+            addSoundForNote(midiNote, new StreamingSamplerSound("_" + juce::String(midiNote) + "_wav", *samplePool, midiNote));
+
+        samplePool->requestSampleRate(getSampleRate());
+        return;
+    }
 
-    for (int midiNote = 24; midiNote <= 101; ++midiNote)
+    for (int midiNote = SamplePool::lowestNote; midiNote <= SamplePool::highestNote; ++midiNote)
     {
         juce::String fileName = "_" + juce::String(midiNote) + "_wav";
         int size = 0;
@@ -43,14 +197,14 @@ void Synth::loadSamples()
                 allNotes.setBit(midiNote);
 
                 // Add the sample to the synthesizer with the specified MIDI note
-                addSound(new juce::SamplerSound(
+                addSoundForNote(midiNote, new InMemorySamplerSound(
                     fileName,
                     *formatReader,
                     allNotes,
                     midiNote,
                     0.0,   // Attack time
                     0.0,   // Release time
-                    10.0)); // Maximum sample length
+                    SamplePool::maxSampleLengthSeconds)); // Maximum sample length
                 
                 delete formatReader;
             }
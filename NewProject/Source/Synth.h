@@ -13,13 +13,86 @@
 #include <JuceHeader.h>
 #include "BinaryData.h"
 #include "CustomSamplerVoice.h"
+#include "SamplePool.h"
+#include "SampleStreamer.h"
+#include "VoiceAllocator.h"
 
 class Synth : public juce::Synthesiser
 {
 public:
+    // streaming plays from the process-wide SamplePool, inMemory decodes a private
+    // copy of every sample up front as juce::SamplerSounds
+    enum class SampleMode { streaming, inMemory };
+
     Synth();
-    void loadSamples();
+    ~Synth() override;
+
+    void loadSamples(SampleMode mode = SampleMode::streaming);
+
+    // Also asks the pool for a copy of the bank at this rate, built in the background
+    void setCurrentPlaybackSampleRate(double sampleRate) override;
+
+    // Voices come from a VoiceAllocator instead of a scan, and new notes restrike
+    // a voice already on the same note rather than stealing another
+    void noteOn(int midiChannel, int midiNoteNumber, float velocity) override;
+
+    // Polyphony, 1 to maxVoices. Audio thread safe, the voices all exist up
+    // front and the ones above the limit just aren't used
+    void setNumVoices(int numVoices);
+    int getNumVoices() const noexcept { return allocator.getNumVoices(); }
+    int getNumActiveVoices() const noexcept { return allocator.getNumActiveVoices(); }
+
+    // Called after each block with how much of its deadline rendering the voices
+    // took (1 = all of it). Over the budget, the quietest voice is faded out,
+    // and the next one once that fade has finished if it's still over
+    void enforceCpuBudget(double load);
+    void setCpuBudget(double fractionOfDeadline) noexcept { cpuBudget = fractionOfDeadline; }
+    int getNumVoicesDropped() const noexcept { return voicesDropped.load(std::memory_order_relaxed); }
+
+    static constexpr int maxVoices = 64;
+    static constexpr int defaultNumVoices = 32;
+
+    // Forwarded to every voice, cheap to call each block
+    void setPitchBend(float semitones);
+    void setResamplerQuality(Resampler::Quality quality);
+
+    // Voices whose output peak stays under this many dBFS end early. At or
+    // below cullOff every voice plays to the end of its envelope
+    void setCullThreshold(float decibels);
+    int getNumVoicesCulled() const noexcept { return allocator.getNumVoicesCulled(); }
+
+    static constexpr float cullOff = -200.0f;
+    static constexpr float defaultCullThreshold = -90.0f;
+
+    SampleStreamer& getStreamer() noexcept { return streamer; }
+    const SampleStreamer& getStreamer() const noexcept { return streamer; }
+
+    // Streaming mode loads in the background, notes are silent until this is true
+    bool areSamplesLoaded() const noexcept { return sampleMode == SampleMode::inMemory || samplePool->isLoaded(); }
+    float getLoadingProgress() const noexcept { return areSamplesLoaded() ? 1.0f : samplePool->getLoadingProgress(); }
+
+    // True once voices play at the host rate without converting (bends aside)
+    bool areSamplesAtHostRate() const noexcept
+    {
+        return sampleMode == SampleMode::inMemory || samplePool->isReadyForSampleRate(getSampleRate());
+    }
 
 private:
+    void addSoundForNote(int midiNote, juce::SynthesiserSound* sound);
+
     juce::AudioFormatManager formatManager;
+    SampleMode sampleMode = SampleMode::streaming;
+    float pitchBend = 0.0f;
+    Resampler::Quality resamplerQuality = Resampler::Quality::sinc;
+    float cullThreshold = cullOff;
+    juce::SharedResourcePointer<SamplePool> samplePool;
+    SampleStreamer streamer;
+    VoiceAllocator allocator{ maxVoices };
+
+    // Sound for each MIDI note, so noteOn doesn't ask all 78 of them
+    std::array<juce::SynthesiserSound*, 128> soundForNote{};
+
+    double cpuBudget = 0.8;
+    int lastDroppedVoice = -1;
+    std::atomic<int> voicesDropped{ 0 };
 };
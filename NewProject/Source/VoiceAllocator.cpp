@@ -0,0 +1,171 @@
+/*
+  ==============================================================================
+
+    VoiceAllocator.cpp
+    Created: 21 Oct 2026 11:02:17am
+    Author:  mikey
+
+  ==============================================================================
+*/
+
+#include "VoiceAllocator.h"
+
+VoiceAllocator::VoiceAllocator(int maxVoices)
+    : slots(static_cast<size_t>(maxVoices)),
+      freeVoices(static_cast<size_t>(maxVoices), -1)
+{
+    heldVoiceForNote.fill(-1);
+    setNumVoices(maxVoices);
+}
+
+void VoiceAllocator::setNumVoices(int newNumVoices) noexcept
+{
+    newNumVoices = juce::jlimit(1, getMaxVoices(), newNumVoices);
+
+    if (newNumVoices == numVoices)
+        return;
+
+    numVoices = newNumVoices;
+
+    // Rebuilt in index order (handed out from the top), only when polyphony changes
+    for (int i = 0; i < numFree; ++i)
+        slots[static_cast<size_t>(freeVoices[static_cast<size_t>(i)])].freePosition = -1;
+
+    numFree = 0;
+
+    for (int i = numVoices; --i >= 0;)
+        if (!slots[static_cast<size_t>(i)].active)
+            pushFree(i);
+}
+
+void VoiceAllocator::pushFree(int index) noexcept
+{
+    auto& slot = slots[static_cast<size_t>(index)];
+
+    if (slot.freePosition >= 0 || index >= numVoices)
+        return;
+
+    slot.freePosition = numFree;
+    freeVoices[static_cast<size_t>(numFree++)] = index;
+}
+
+void VoiceAllocator::removeFree(int index) noexcept
+{
+    auto& slot = slots[static_cast<size_t>(index)];
+
+    if (slot.freePosition < 0)
+        return;
+
+    // Swap with the top of the stack
+    const int last = freeVoices[static_cast<size_t>(--numFree)];
+    freeVoices[static_cast<size_t>(slot.freePosition)] = last;
+    slots[static_cast<size_t>(last)].freePosition = slot.freePosition;
+    slot.freePosition = -1;
+}
+
+int VoiceAllocator::findFreeVoice() const noexcept
+{
+    return numFree > 0 ? freeVoices[static_cast<size_t>(numFree - 1)] : -1;
+}
+
+int VoiceAllocator::getHeldVoiceForNote(int midiNote) const noexcept
+{
+    return juce::isPositiveAndBelow(midiNote, 128) ? heldVoiceForNote[static_cast<size_t>(midiNote)] : -1;
+}
+
+int VoiceAllocator::findVoiceToSteal(int midiNote) const noexcept
+{
+    int sameNote = -1, oldestReleased = -1, quietest = -1;
+
+    for (int i = 0; i < numVoices; ++i)
+    {
+        auto& slot = slots[static_cast<size_t>(i)];
+
+        if (!slot.active)
+            continue;
+
+        if (slot.midiNote == midiNote)
+            sameNote = i;
+
+        if (slot.released)
+        {
+            if (oldestReleased < 0 || slot.releaseOrder < slots[static_cast<size_t>(oldestReleased)].releaseOrder)
+                oldestReleased = i;
+        }
+        else if (quietest < 0 || slot.level < slots[static_cast<size_t>(quietest)].level)
+        {
+            quietest = i;
+        }
+    }
+
+    if (sameNote >= 0)
+        return sameNote;
+
+    return oldestReleased >= 0 ? oldestReleased : quietest;
+}
+
+int VoiceAllocator::findQuietestVoice() const noexcept
+{
+    int quietest = -1;
+
+    for (int i = 0; i < getMaxVoices(); ++i)
+    {
+        auto& slot = slots[static_cast<size_t>(i)];
+
+        if (slot.active && !slot.dropping
+            && (quietest < 0 || slot.level < slots[static_cast<size_t>(quietest)].level))
+            quietest = i;
+    }
+
+    return quietest;
+}
+
+void VoiceAllocator::voiceStarted(int index, int midiNote) noexcept
+{
+    auto& slot = slots[static_cast<size_t>(index)];
+
+    removeFree(index);
+
+    if (!slot.active)
+        numActive.store(numActive.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    slot.active = true;
+    slot.released = false;
+    slot.dropping = false;
+    slot.midiNote = midiNote;
+    slot.level = 1.0f; // Loud until it's rendered, so a new note isn't the first to go
+
+    if (juce::isPositiveAndBelow(midiNote, 128))
+        heldVoiceForNote[static_cast<size_t>(midiNote)] = index;
+}
+
+void VoiceAllocator::voiceReleased(int index) noexcept
+{
+    auto& slot = slots[static_cast<size_t>(index)];
+
+    if (!slot.active || slot.released)
+        return;
+
+    slot.released = true;
+    slot.releaseOrder = nextReleaseOrder++;
+
+    if (juce::isPositiveAndBelow(slot.midiNote, 128) && heldVoiceForNote[static_cast<size_t>(slot.midiNote)] == index)
+        heldVoiceForNote[static_cast<size_t>(slot.midiNote)] = -1;
+}
+
+void VoiceAllocator::voiceFinished(int index) noexcept
+{
+    auto& slot = slots[static_cast<size_t>(index)];
+
+    if (slot.active)
+    {
+        voiceReleased(index);
+        numActive.store(numActive.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+    }
+
+    slot.active = false;
+    slot.dropping = false;
+    slot.level = 0.0f;
+
+    pushFree(index);
+}
@@ -0,0 +1,90 @@
+/*
+  ==============================================================================
+
+    VoiceAllocator.h
+    Created: 21 Oct 2026 11:02:17am
+    Author:  mikey
+
+  ==============================================================================
+*/
+
+#pragma once
+#include <JuceHeader.h>
+
+// Bookkeeping for the Synth's single pool of voices, by index. The voices report
+// their own starts, releases, ends and output level, so a free voice is a pop off
+// a stack rather than a scan, and stealing picks from what's already known:
+//  1. a voice already on the same note (a piano restrikes its own string)
+//  2. the voice that was released longest ago
+//  3. the quietest voice still held
+// Only the first getNumVoices() voices are ever handed out, so polyphony can
+// change at runtime without creating or deleting voices.
+// Audio thread only, like the rest of the Synthesiser's voice handling.
+class VoiceAllocator
+{
+public:
+    explicit VoiceAllocator(int maxVoices);
+
+    // Voices from numVoices up stop being handed out, the Synth fades out any
+    // that are still playing
+    void setNumVoices(int numVoices) noexcept;
+    int getNumVoices() const noexcept { return numVoices; }
+    int getMaxVoices() const noexcept { return static_cast<int>(slots.size()); }
+
+    // Index of a free voice, or -1. It stays free until the voice starts
+    int findFreeVoice() const noexcept;
+
+    // Held (not yet released) voice for a note, or -1
+    int getHeldVoiceForNote(int midiNote) const noexcept;
+
+    // Best voice to take over for a new note on midiNote, or -1 if nothing is playing
+    int findVoiceToSteal(int midiNote) const noexcept;
+
+    // Quietest playing voice that isn't already on its way out, or -1
+    int findQuietestVoice() const noexcept;
+
+    // From the voices themselves
+    void voiceStarted(int index, int midiNote) noexcept;
+    void voiceReleased(int index) noexcept;
+    void voiceFinished(int index) noexcept;
+    void setLevel(int index, float level) noexcept { slots[static_cast<size_t>(index)].level = level; }
+
+    // From the Synth, once it's told a voice to fade out quickly
+    void setDropping(int index) noexcept { slots[static_cast<size_t>(index)].dropping = true; }
+    bool isDropping(int index) const noexcept { return slots[static_cast<size_t>(index)].dropping; }
+
+    bool isActive(int index) const noexcept { return slots[static_cast<size_t>(index)].active; }
+
+    // Any thread, only the audio thread changes it
+    int getNumActiveVoices() const noexcept { return numActive.load(std::memory_order_relaxed); }
+
+    // Voices that ended early because they'd gone inaudible. Any thread
+    void voiceCulled() noexcept { numCulled.fetch_add(1, std::memory_order_relaxed); }
+    int getNumVoicesCulled() const noexcept { return numCulled.load(std::memory_order_relaxed); }
+
+private:
+    void pushFree(int index) noexcept;
+    void removeFree(int index) noexcept;
+
+    struct Slot
+    {
+        bool active = false;
+        bool released = false;
+        bool dropping = false;
+        int midiNote = -1;
+        juce::uint64 releaseOrder = 0;
+        float level = 0.0f;
+        int freePosition = -1; // Where it sits in freeVoices, -1 if it's not there
+    };
+
+    std::vector<Slot> slots;
+    std::vector<int> freeVoices; // Stack, the last one is handed out next
+    int numFree = 0;
+    int numVoices = 0;
+    std::atomic<int> numActive{ 0 };
+    juce::uint64 nextReleaseOrder = 1;
+    std::array<int, 128> heldVoiceForNote;
+    std::atomic<int> numCulled{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VoiceAllocator)
+};
@@ -12,14 +12,14 @@
 #include "WaveScreen.h"
 
 //==============================================================================
-bool WaveScreen::isScreenEnabled = false;
+std::atomic<bool> WaveScreen::isScreenEnabled{ false };
 
 WaveScreen::WaveScreen()
 {
     // AudioVisualizer
     audioVisualiser.setRepaintRate(30);
     audioVisualiser.setBufferSize(1024);
-    audioVisualiser.setSamplesPerBlock(32);
+    audioVisualiser.setSamplesPerBlock(32 / scopeDecimation); // Same time scale as undecimated blocks of 32
     audioVisualiser.setNumChannels(1);
     audioVisualiser.setColours(juce::Colours::black, juce::Colours::white);
     audioVisualiser.setEnabled(true);
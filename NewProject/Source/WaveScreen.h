@@ -27,14 +27,18 @@ public:
 
     // Visualiser
     void pushBufferIntoVisualiser(const juce::AudioBuffer<float>& buffer);
-    static bool getVisualiserStatus() { return isScreenEnabled; }
+    static bool getVisualiserStatus() { return isScreenEnabled.load(std::memory_order_relaxed); }
     juce::AudioVisualiserComponent audioVisualiser{ 1 }; // mono audio
 
+    // The scope is fed one of every scopeDecimation samples
+    static constexpr int scopeDecimation = 4;
+
 private:
     juce::ToggleButton screenButton;
     std::unique_ptr<ToggleButton> toggleButtonLookAndFeel;
 
-	static bool isScreenEnabled;
+	// Read by the audio thread
+	static std::atomic<bool> isScreenEnabled;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WaveScreen)
 };